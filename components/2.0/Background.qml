@@ -23,11 +23,12 @@
 ***************************************************************************/
 
 import QtQuick 2.0
+import QtQuick.Window 2.2
 
 FocusScope {
     id: container
 
-    property alias source: image.source
+    property url source
     property alias fillMode: image.fillMode
     property alias status: image.status
 
@@ -36,6 +37,25 @@ FocusScope {
         id: image
         anchors.fill: parent
 
+        // local files go through the greeter's background cache, which
+        // decodes them once at the size of the screen for all views; the
+        // size is part of the id rather than sourceSize so the image keeps
+        // its aspect ratio and fillMode works as before. It is the screen's
+        // rather than ours, so resizes while the scene is laid out don't
+        // decode the image again at sizes nobody needs
+        source: {
+            if (container.source.toString() === "")
+                return ""
+            var url = Qt.resolvedUrl(container.source).toString()
+            if (!/^(file|qrc):/.test(url))
+                return url
+            if (Screen.width <= 0 || Screen.height <= 0)
+                return ""
+            var width = Math.ceil(Screen.width * Screen.devicePixelRatio)
+            var height = Math.ceil(Screen.height * Screen.devicePixelRatio)
+            return "image://sddm-background/" + width + "x" + height + "/" + encodeURIComponent(url)
+        }
+
         clip: true
         focus: true
         smooth: true
@@ -27,7 +27,7 @@ import QtQuick 2.0
 ComboBox {
     id: combo
 
-    model: keyboard.layouts
+    model: keyboard.layoutModel
     index: keyboard.currentLayout
 
     function onValueChanged(id) {
@@ -22,8 +22,13 @@
 #include "Constants.h"
 #include "AuthMessages.h"
 #include "SafeDataStream.h"
+#include "ProcessReaper.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
 #include <QtCore/QProcess>
+#include <QtCore/QTimer>
 #include <QtCore/QUuid>
 #include <QtNetwork/QLocalServer>
 #include <QtNetwork/QLocalSocket>
@@ -42,9 +47,13 @@ namespace SDDM {
     public:
         static SocketServer *instance();
 
-        QMap<qint64, Auth::Private*> helpers;
+        QHash<qint64, Auth::Private*> helpers;
     private:
         SocketServer();
+        void handshake(QLocalSocket *socket);
+
+        // accepted connections whose HELLO hasn't arrived yet
+        QHash<QLocalSocket*, QElapsedTimer> m_pending;
     };
 
     class Auth::Private : public QObject {
@@ -61,8 +70,14 @@ namespace SDDM {
     public:
         AuthRequest *request { nullptr };
         QProcess *child { nullptr };
-        QLocalSocket *socket { nullptr };
+        QPointer<QLocalSocket> socket;
+        QElapsedTimer accepted;
+        qint64 authenticationLatency { -1 };
+        qint64 groupLookupTime { -1 };
+        qint64 vtSwitchTime { -1 };
         QString displayServerCmd;
+        QString backend;
+        QString helperPath { QStringLiteral("%1/sddm-helper").arg(QStringLiteral(LIBEXEC_INSTALL_DIR)) };
         QString sessionPath { };
         QString user { };
         QByteArray cookie { };
@@ -75,6 +90,9 @@ namespace SDDM {
 
     qint64 Auth::Private::lastId = 1;
 
+    // how long a helper may take to introduce itself
+    static const int HelloTimeout = 10000;
+
 
 
     Auth::SocketServer::SocketServer()
@@ -83,21 +101,54 @@ namespace SDDM {
     }
 
     void Auth::SocketServer::handleNewConnection()  {
+        // never wait for a helper here, one slow helper would hold up all the others
         while (hasPendingConnections()) {
-            Msg m = Msg::MSG_UNKNOWN;
-            qint64 id;
             QLocalSocket *socket = nextPendingConnection();
-            SafeDataStream str(socket);
-            str.receive();
-            str >> m >> id;
-            if (m == Msg::HELLO && id && SocketServer::instance()->helpers.contains(id)) {
-                helpers[id]->setSocket(socket);
-                if (socket->bytesAvailable() > 0)
-                    helpers[id]->dataPending();
-            }
+            m_pending[socket].start();
+
+            connect(socket, &QLocalSocket::readyRead, this, [this, socket] { handshake(socket); });
+            connect(socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater);
+            connect(socket, &QObject::destroyed, this, [this, socket] { m_pending.remove(socket); });
+            QTimer::singleShot(HelloTimeout, socket, [this, socket] {
+                if (!m_pending.contains(socket))
+                    return;
+                qWarning() << "Auth: Helper didn't introduce itself in time, dropping the connection";
+                socket->abort();
+                socket->deleteLater();
+            });
+
+            if (socket->bytesAvailable() > 0)
+                handshake(socket);
         }
     }
 
+    void Auth::SocketServer::handshake(QLocalSocket *socket) {
+        SafeDataStream str(socket);
+        if (!m_pending.contains(socket) || !str.canReceive())
+            return;
+
+        Msg m = Msg::MSG_UNKNOWN;
+        qint64 id = 0;
+        str.receive();
+        str >> m >> id;
+
+        const QElapsedTimer accepted = m_pending.take(socket);
+        disconnect(socket, &QLocalSocket::readyRead, this, nullptr);
+
+        Auth::Private *helper = m == Msg::HELLO ? helpers.value(id) : nullptr;
+        if (!helper) {
+            qWarning() << "Auth: Unexpected connection, dropping it";
+            socket->abort();
+            socket->deleteLater();
+            return;
+        }
+
+        helper->accepted = accepted;
+        helper->setSocket(socket);
+        if (socket->bytesAvailable() > 0)
+            helper->dataPending();
+    }
+
     Auth::SocketServer* Auth::SocketServer::instance() {
         static std::unique_ptr<Auth::SocketServer> self;
         if (!self) {
@@ -153,7 +204,8 @@ namespace SDDM {
         Auth *auth = qobject_cast<Auth*>(parent());
         Msg m = MSG_UNKNOWN;
         SafeDataStream str(socket);
-        while (socket->bytesAvailable() > 0) {
+        // only whole messages, the rest arrives with the next readyRead
+        while (str.canReceive()) {
             str.receive();
             str >> m;
             switch (m) {
@@ -180,6 +232,8 @@ namespace SDDM {
                 case AUTHENTICATED: {
                     QString user;
                     str >> user;
+                    if (accepted.isValid())
+                        authenticationLatency = accepted.elapsed();
                     if (!user.isEmpty()) {
                         auth->setUser(user);
                         Q_EMIT auth->authentication(user, true);
@@ -194,7 +248,7 @@ namespace SDDM {
                 }
                 case SESSION_STATUS: {
                     bool status;
-                    str >> status;
+                    str >> status >> groupLookupTime >> vtSwitchTime;
                     Q_EMIT auth->sessionStarted(status);
                     str.reset();
                     str << SESSION_STATUS;
@@ -239,6 +293,10 @@ namespace SDDM {
     }
 
     void Auth::Private::requestFinished() {
+        // the helper is gone already
+        if (!socket)
+            return;
+
         SafeDataStream str(socket);
         Request r = request->request();
         str << REQUEST << r;
@@ -263,6 +321,8 @@ namespace SDDM {
 
     Auth::~Auth() {
         stop();
+        // let the helper finish its cleanup after we are gone
+        ProcessReaper::adopt(d->child);
         delete d;
     }
 
@@ -301,6 +361,18 @@ namespace SDDM {
         return d->request;
     }
 
+    qint64 Auth::authenticationLatency() const {
+        return d->authenticationLatency;
+    }
+
+    qint64 Auth::groupLookupTime() const {
+        return d->groupLookupTime;
+    }
+
+    qint64 Auth::vtSwitchTime() const {
+        return d->vtSwitchTime;
+    }
+
     bool Auth::isActive() const {
         return d->child->state() != QProcess::NotRunning;
     }
@@ -350,6 +422,16 @@ namespace SDDM {
         }
     }
 
+    void Auth::setBackend(const QString &backend)
+    {
+        d->backend = backend;
+    }
+
+    void Auth::setHelperPath(const QString &path)
+    {
+        d->helperPath = path;
+    }
+
     void Auth::setSession(const QString& path) {
         if (path != d->sessionPath) {
             d->sessionPath = path;
@@ -368,6 +450,11 @@ namespace SDDM {
     }
 
     void Auth::start() {
+        d->accepted.invalidate();
+        d->authenticationLatency = -1;
+        d->groupLookupTime = -1;
+        d->vtSwitchTime = -1;
+
         QStringList args;
         args << QStringLiteral("--socket") << SocketServer::instance()->fullServerName();
         args << QStringLiteral("--id") << QString::number(d->id);
@@ -381,19 +468,17 @@ namespace SDDM {
             args << QStringLiteral("--display-server") << d->displayServerCmd;
         if (d->greeter)
             args << QStringLiteral("--greeter");
-        d->child->start(QStringLiteral("%1/sddm-helper").arg(QStringLiteral(LIBEXEC_INSTALL_DIR)), args);
+        if (!d->backend.isEmpty())
+            args << QStringLiteral("--backend") << d->backend;
+        d->child->start(d->helperPath, args);
     }
 
     void Auth::stop() {
-        if (d->child->state() == QProcess::NotRunning) {
-            return;
-        }
-
-        d->child->terminate();
+        ProcessReaper::terminate(d->child, 5000);
+    }
 
-        // wait for finished
-        if (!d->child->waitForFinished(5000))
-            d->child->kill();
+    void Auth::terminate(const std::function<void()> &done) {
+        ProcessReaper::terminate(d->child, 5000, done);
     }
 }
 
@@ -27,6 +27,8 @@
 #include <QtCore/QObject>
 #include <QtCore/QProcessEnvironment>
 
+#include <functional>
+
 namespace SDDM {
     /**
     * \brief
@@ -104,6 +106,24 @@ namespace SDDM {
          */
         bool isActive() const;
 
+        /**
+         * Milliseconds from accepting the helper's connection until it
+         * reported the authentication result, -1 if it hasn't yet
+         */
+        qint64 authenticationLatency() const;
+
+        /**
+         * Milliseconds the helper spent resolving the user's groups
+         * for the session, -1 if it didn't report it
+         */
+        qint64 groupLookupTime() const;
+
+        /**
+         * Milliseconds the helper's switch to the session's VT took,
+         * -1 if it didn't switch or report it
+         */
+        qint64 vtSwitchTime() const;
+
         /**
         * If starting a session, you will probably want to provide some basic env variables for the session.
         * This only inserts the variables - if the current key already had a value, it will be overwritten.
@@ -150,6 +170,19 @@ namespace SDDM {
          */
         void setDisplayServerCommand(const QString &command);
 
+        /**
+        * Sets the authentication backend of the helper, as name[:options].
+        * Only backends the helper was built with are honored, PAM otherwise.
+        * @param backend the backend, empty for the default
+        */
+        void setBackend(const QString &backend);
+
+        /**
+        * Runs another helper binary, for tests.
+        * @param path path of the helper
+        */
+        void setHelperPath(const QString &path);
+
         /**
         * Set the session to be started after authenticating.
         * @param path Path of the session executable to be started
@@ -162,6 +195,12 @@ namespace SDDM {
          */
         void setCookie(const QByteArray &cookie);
 
+        /**
+         * Stops the helper like stop() and calls @p done once it has exited
+         * @param done called when the helper is gone, right away if it is not running
+         */
+        void terminate(const std::function<void()> &done);
+
     public Q_SLOTS:
         /**
         * Sets up the environment and starts the authentication
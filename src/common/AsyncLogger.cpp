@@ -0,0 +1,336 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "AsyncLogger.h"
+
+#include "Constants.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace SDDM {
+    static const char *fieldNames[] = { "seat", "display", "login" };
+    static const char s_ellipsis[] = "\xe2\x80\xa6";
+
+    // innermost scope of the current thread
+    static thread_local const AsyncLogger::Scope *t_scope = nullptr;
+
+    static const char *priority(QtMsgType type) {
+        switch (type) {
+            case QtWarningMsg:
+                return "(WW)";
+            case QtCriticalMsg:
+            case QtFatalMsg:
+                return "(EE)";
+            default:
+                return "(II)";
+        }
+    }
+
+    // "[hh:mm:ss.zzz] (II) text\tpid=1 seat=seat0\n", like standardLogger plus the fields
+    static void formatLine(QByteArray &out, qint64 msecs, QtMsgType type, const char *text, int length, const QByteArray &fields) {
+        time_t secs = msecs / 1000;
+        struct tm tm;
+        localtime_r(&secs, &tm);
+
+        char prefix[32];
+        int n = snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03d] %s ",
+                         tm.tm_hour, tm.tm_min, tm.tm_sec, int(msecs % 1000), priority(type));
+        out.append(prefix, n);
+        out.append(text, length);
+        out.append('\t');
+        out.append(fields);
+        out.append('\n');
+    }
+
+    // copies at most capacity bytes of text, cut at a character boundary and marked with "…"
+    static int copyCut(char *dest, int capacity, const QByteArray &text) {
+        if (text.size() <= capacity) {
+            memcpy(dest, text.constData(), text.size());
+            return int(text.size());
+        }
+
+        int length = capacity - int(sizeof(s_ellipsis) - 1);
+        while (length > 0 && (uchar(text.at(length)) & 0xc0) == 0x80)
+            --length;
+        memcpy(dest, text.constData(), length);
+        memcpy(dest + length, s_ellipsis, sizeof(s_ellipsis) - 1);
+        return length + int(sizeof(s_ellipsis) - 1);
+    }
+
+    AsyncLogger::Scope::Scope(const QString &seat, const QString &display) : m_active(isEnabled()) {
+        if (!m_active)
+            return;
+
+        m_seat = seat.toUtf8();
+        m_display = display.toUtf8();
+        m_outer = t_scope;
+        t_scope = this;
+    }
+
+    AsyncLogger::Scope::~Scope() {
+        if (m_active)
+            t_scope = m_outer;
+    }
+
+    bool AsyncLogger::isEnabled() {
+        static const bool enabled = qgetenv("SDDM_LOG_SINK") == "async";
+        return enabled;
+    }
+
+    AsyncLogger *AsyncLogger::instance() {
+        static AsyncLogger logger;
+        return &logger;
+    }
+
+    void AsyncLogger::setField(Field field, const QString &value) {
+        if (!isEnabled())
+            return;
+
+        instance()->updateField(field, value);
+    }
+
+    void AsyncLogger::updateField(Field field, const QString &value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto fields = std::make_shared<Fields>(*std::atomic_load(&m_fields));
+        fields->values[field] = value.toUtf8();
+        std::atomic_store(&m_fields, std::shared_ptr<const Fields>(std::move(fields)));
+    }
+
+    QByteArray AsyncLogger::renderFields(pid_t pid) const {
+        const std::shared_ptr<const Fields> fields = std::atomic_load(&m_fields);
+        QByteArray values[FieldCount];
+        for (int i = 0; i < FieldCount; ++i)
+            values[i] = fields->values[i];
+
+        // the innermost scope that has a value wins
+        QByteArray seat, display;
+        for (const Scope *scope = t_scope; scope; scope = scope->m_outer) {
+            if (seat.isEmpty())
+                seat = scope->m_seat;
+            if (display.isEmpty())
+                display = scope->m_display;
+        }
+        if (!seat.isEmpty())
+            values[Seat] = seat;
+        if (!display.isEmpty())
+            values[Display] = display;
+
+        QByteArray rendered = "pid=" + QByteArray::number(pid);
+        for (int i = 0; i < FieldCount; ++i) {
+            if (!values[i].isEmpty())
+                rendered += ' ' + QByteArray(fieldNames[i]) + '=' + values[i];
+        }
+        return rendered;
+    }
+
+    AsyncLogger::AsyncLogger(int fd) : m_fields(std::make_shared<Fields>()), m_pid(getpid()), m_fd(fd) {
+        for (int i = 0; i < SlotCount; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+        if (m_fd < 0)
+            openOutput();
+
+        // whatever the environment already tells us
+        updateField(Seat, qEnvironmentVariable("XDG_SEAT"));
+        updateField(Display, qEnvironmentVariableIsSet("WAYLAND_DISPLAY") ? qEnvironmentVariable("WAYLAND_DISPLAY") : qEnvironmentVariable("DISPLAY"));
+        updateField(LoginId, qEnvironmentVariable("XDG_SESSION_ID"));
+
+        m_thread = std::thread(&AsyncLogger::run, this);
+    }
+
+    AsyncLogger::~AsyncLogger() {
+        m_quit = true;
+        m_wakeUp.notify_one();
+        if (m_thread.joinable())
+            m_thread.join();
+        if (m_fd > STDERR_FILENO)
+            close(m_fd);
+    }
+
+    void AsyncLogger::openOutput() {
+        // same destinations as standardLogger
+        if (isatty(STDERR_FILENO)) {
+            m_fd = STDERR_FILENO;
+            return;
+        }
+
+        m_fd = open(LOG_FILE, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0) {
+            const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+            QDir().mkpath(dir);
+            m_fd = open(QFile::encodeName(dir + QLatin1String("/sddm.log")).constData(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        }
+        if (m_fd < 0)
+            m_fd = STDERR_FILENO;
+    }
+
+    void AsyncLogger::log(QtMsgType type, const QString &msg) {
+        const QByteArray text = msg.toUtf8();
+
+        // we were forked, nobody is draining the ring in this process
+        const pid_t pid = getpid();
+        if (pid != m_pid) {
+            char buffer[SlotSize];
+            const int length = copyCut(buffer, SlotSize, text);
+            QByteArray line;
+            formatLine(line, QDateTime::currentMSecsSinceEpoch(), type, buffer, length, renderFields(pid));
+            write(line);
+            return;
+        }
+
+        if (rateLimited(type))
+            return;
+
+        // the fields are those of the moment the message is logged
+        if (!enqueue(type, text, renderFields(m_pid)))
+            m_overflowed.fetch_add(1, std::memory_order_relaxed);
+
+        // don't lose what explains a crash
+        if (type == QtFatalMsg)
+            flush();
+        else if (type != QtDebugMsg && type != QtInfoMsg)
+            m_wakeUp.notify_one();
+    }
+
+    void AsyncLogger::flush() {
+        const quint64 target = m_enqueuePos.load(std::memory_order_acquire);
+
+        // wait for the flusher to get there, but don't hang forever on a stuck disk
+        for (int i = 0; i < 100 && m_dequeuePosPublished.load(std::memory_order_acquire) < target; ++i) {
+            m_wakeUp.notify_one();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    bool AsyncLogger::rateLimited(QtMsgType type) {
+        // errors always get through
+        if (type == QtCriticalMsg || type == QtFatalMsg)
+            return false;
+
+        const qint64 now = time(nullptr);
+        qint64 window = m_window.load(std::memory_order_relaxed);
+        if (window != now && m_window.compare_exchange_strong(window, now, std::memory_order_relaxed))
+            m_windowCount.store(0, std::memory_order_relaxed);
+
+        if (m_windowCount.fetch_add(1, std::memory_order_relaxed) < MaxPerSecond)
+            return false;
+
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool AsyncLogger::enqueue(QtMsgType type, const QByteArray &text, const QByteArray &fields) {
+        // bounded multi-producer queue, every slot's sequence tells whose turn it is
+        quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &m_slots[pos % SlotCount];
+            const quint64 sequence = slot->sequence.load(std::memory_order_acquire);
+            const qint64 diff = qint64(sequence) - qint64(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                // full
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->time = QDateTime::currentMSecsSinceEpoch();
+        slot->type = type;
+        slot->length = copyCut(slot->text, SlotSize, text);
+        slot->fieldsLength = copyCut(slot->fields, FieldsSize, fields);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // getting crowded, don't wait for the timer
+        if (pos - m_dequeuePosPublished.load(std::memory_order_relaxed) > SlotCount / 2)
+            m_wakeUp.notify_one();
+
+        return true;
+    }
+
+    void AsyncLogger::run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_quit) {
+            m_wakeUp.wait_for(lock, std::chrono::milliseconds(250));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+        lock.unlock();
+        drain();
+    }
+
+    void AsyncLogger::drain() {
+        QByteArray out;
+
+        for (;;) {
+            Slot &slot = m_slots[m_dequeuePos % SlotCount];
+            if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+                break;
+
+            formatLine(out, slot.time, slot.type, slot.text, slot.length, QByteArray::fromRawData(slot.fields, slot.fieldsLength));
+            slot.sequence.store(m_dequeuePos + SlotCount, std::memory_order_release);
+            ++m_dequeuePos;
+        }
+
+        // our own reports carry the fields of the process
+        const QByteArray fields = renderFields(m_pid);
+        const quint64 suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        if (suppressed > 0) {
+            const QByteArray text = QByteArray::number(suppressed) + " messages suppressed by the rate limit";
+            formatLine(out, QDateTime::currentMSecsSinceEpoch(), QtWarningMsg, text.constData(), text.size(), fields);
+        }
+        const quint64 overflowed = m_overflowed.exchange(0, std::memory_order_relaxed);
+        if (overflowed > 0) {
+            const QByteArray text = QByteArray::number(overflowed) + " messages dropped, log buffer full";
+            formatLine(out, QDateTime::currentMSecsSinceEpoch(), QtWarningMsg, text.constData(), text.size(), fields);
+        }
+
+        if (!out.isEmpty())
+            write(out);
+
+        m_dequeuePosPublished.store(m_dequeuePos, std::memory_order_release);
+    }
+
+    void AsyncLogger::write(const QByteArray &data) {
+        qint64 written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(m_fd, data.constData() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            written += n;
+        }
+    }
+}
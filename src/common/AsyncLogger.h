@@ -0,0 +1,142 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_ASYNCLOGGER_H
+#define SDDM_ASYNCLOGGER_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace SDDM {
+    /**
+     * Log sink that never blocks the caller on I/O.
+     *
+     * Messages are copied into a fixed size lock-free ring buffer and written
+     * out in batches by a background thread. Every line carries the pid and
+     * the seat, display and login ID it was logged for, either those of the
+     * process or those of the Scope it was logged in. Bursts above
+     * MaxPerSecond messages are dropped and counted, so is everything that
+     * doesn't fit into the ring anymore.
+     *
+     * Enabled by setting SDDM_LOG_SINK=async in the environment.
+     */
+    class AsyncLogger {
+        Q_DISABLE_COPY(AsyncLogger)
+    public:
+        enum Field {
+            Seat,
+            Display,
+            LoginId,
+            FieldCount
+        };
+
+        /**
+         * Labels the messages logged on this thread while it exists with
+         * a seat and display, for processes that serve several of them.
+         * Scopes nest, empty values leave those of the outer scope.
+         */
+        class Scope {
+            Q_DISABLE_COPY(Scope)
+        public:
+            Scope(const QString &seat, const QString &display);
+            ~Scope();
+
+        private:
+            friend class AsyncLogger;
+
+            const Scope *m_outer { nullptr };
+            QByteArray m_seat;
+            QByteArray m_display;
+            bool m_active { false };
+        };
+
+        // writes to fd, or where standardLogger would for -1; takes ownership of fd
+        explicit AsyncLogger(int fd = -1);
+        ~AsyncLogger();
+
+        static bool isEnabled();
+        static AsyncLogger *instance();
+
+        // no-op unless the async sink is in use
+        static void setField(Field field, const QString &value);
+
+        // for the messages logged from now on, those already logged keep theirs
+        void updateField(Field field, const QString &value);
+
+        void log(QtMsgType type, const QString &msg);
+        void flush();
+
+    private:
+        static const int SlotCount = 512;
+        static const int SlotSize = 500;
+        static const int FieldsSize = 200;
+        static const int MaxPerSecond = 500;
+
+        struct Slot {
+            std::atomic<quint64> sequence;
+            qint64 time;
+            QtMsgType type;
+            int length;
+            int fieldsLength;
+            char text[SlotSize];
+            char fields[FieldsSize];
+        };
+
+        struct Fields {
+            QByteArray values[FieldCount];
+        };
+
+        QByteArray renderFields(pid_t pid) const;
+        bool enqueue(QtMsgType type, const QByteArray &text, const QByteArray &fields);
+        bool rateLimited(QtMsgType type);
+        void run();
+        void drain();
+        void write(const QByteArray &data);
+        void openOutput();
+
+        Slot m_slots[SlotCount];
+        std::atomic<quint64> m_enqueuePos { 0 };
+        quint64 m_dequeuePos { 0 };
+        std::atomic<quint64> m_dequeuePosPublished { 0 };
+
+        std::atomic<qint64> m_window { 0 };
+        std::atomic<int> m_windowCount { 0 };
+        std::atomic<quint64> m_suppressed { 0 };
+        std::atomic<quint64> m_overflowed { 0 };
+
+        // serializes field updates and wakes up the flusher, never taken by log()
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        // replaced as a whole, log() reads it without locking
+        std::shared_ptr<const Fields> m_fields;
+
+        std::atomic<bool> m_quit { false };
+        std::thread m_thread;
+        pid_t m_pid { 0 };
+        int m_fd { -1 };
+    };
+}
+
+#endif // SDDM_ASYNCLOGGER_H
@@ -0,0 +1,124 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "CacheFile.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <string.h>
+
+namespace SDDM {
+    // the data following it stays 8 byte aligned
+    struct CacheFile::Header {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        qint64 modified;
+        qint64 size;
+    };
+
+    CacheFile::CacheFile(const QString &fileName, const char (&magic)[8], quint32 version)
+        : m_file(fileName), m_version(version) {
+        memcpy(m_magic, magic, sizeof(m_magic));
+    }
+
+    CacheFile::~CacheFile() {
+    }
+
+    QString CacheFile::fileName() const {
+        return m_file.fileName();
+    }
+
+    bool CacheFile::map(const QFileInfo &source) {
+        if (m_data)
+            return true;
+        if (!m_file.open(QIODevice::ReadOnly))
+            return false;
+
+        const qint64 fileSize = m_file.size();
+        const uchar *data = fileSize >= qint64(sizeof(Header)) ? m_file.map(0, fileSize) : nullptr;
+        if (!data) {
+            close();
+            return false;
+        }
+
+        Header header;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, m_magic, sizeof(m_magic)) != 0
+                || header.version != m_version
+                || header.modified != source.lastModified().toMSecsSinceEpoch()
+                || header.size != source.size()) {
+            close();
+            return false;
+        }
+
+        m_data = data + sizeof(Header);
+        m_size = fileSize - qint64(sizeof(Header));
+        return true;
+    }
+
+    bool CacheFile::isMapped() const {
+        return m_data != nullptr;
+    }
+
+    void CacheFile::close() {
+        // unmaps it too
+        m_file.close();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const uchar *CacheFile::data() const {
+        return m_data;
+    }
+
+    qint64 CacheFile::size() const {
+        return m_size;
+    }
+
+    bool CacheFile::write(const QFileInfo &source, const QVector<QByteArray> &parts) {
+        close();
+
+        Header header;
+        memcpy(header.magic, m_magic, sizeof(m_magic));
+        header.version = m_version;
+        header.reserved = 0;
+        header.modified = source.lastModified().toMSecsSinceEpoch();
+        header.size = source.size();
+
+        QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+        QSaveFile out(m_file.fileName());
+        bool ok = out.open(QIODevice::WriteOnly)
+                && out.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+        for (const QByteArray &part : parts) {
+            if (!ok)
+                break;
+            ok = out.write(part) == part.size();
+        }
+        if (!ok || !out.commit()) {
+            qWarning() << "Failed to write the cache file" << m_file.fileName() << out.errorString();
+            return false;
+        }
+        return true;
+    }
+}
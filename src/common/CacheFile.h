@@ -0,0 +1,73 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_CACHEFILE_H
+#define SDDM_CACHEFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class QFileInfo;
+
+namespace SDDM {
+    /**
+     * A binary file caching what was derived from a source file.
+     *
+     * A header names the kind of cache and the version of its layout and
+     * records the modification time and size of the source, the data is
+     * only handed out while all of them match. The file is mapped instead
+     * of read and replaced atomically, so readers never see half of it.
+     * It is only ever read on the machine that wrote it and simply uses
+     * the native byte order.
+     */
+    class CacheFile {
+        Q_DISABLE_COPY(CacheFile)
+    public:
+        CacheFile(const QString &fileName, const char (&magic)[8], quint32 version);
+        ~CacheFile();
+
+        QString fileName() const;
+
+        // maps the file, if it was made from the current source
+        bool map(const QFileInfo &source);
+        bool isMapped() const;
+        void close();
+
+        // what follows the header, while mapped
+        const uchar *data() const;
+        qint64 size() const;
+
+        // writes the parts one after the other and drops the old mapping,
+        // failing only costs the next start another build
+        bool write(const QFileInfo &source, const QVector<QByteArray> &parts);
+
+    private:
+        struct Header;
+
+        QFile m_file;
+        char m_magic[8];
+        quint32 m_version { 0 };
+        const uchar *m_data { nullptr };
+        qint64 m_size { 0 };
+    };
+}
+
+#endif // SDDM_CACHEFILE_H
@@ -30,6 +30,13 @@
 #include <QtCore/QtGlobal>
 #include <QtCore/QStringView>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 QTextStream &operator>>(QTextStream &str, QStringList &list)  {
     list.clear();
 
@@ -127,6 +134,18 @@ namespace SDDM {
     {
     }
 
+    const QString &ConfigBase::path() const {
+        return m_path;
+    }
+
+    ConfigBase::SyncPolicy ConfigBase::syncPolicy() const {
+        return m_syncPolicy;
+    }
+
+    void ConfigBase::setSyncPolicy(SyncPolicy policy) {
+        m_syncPolicy = policy;
+    }
+
     bool ConfigBase::hasUnused() const {
         return m_unusedSections || m_unusedVariables;
     }
@@ -182,9 +201,11 @@ namespace SDDM {
         }
         m_fileModificationTime = latestModificationTime;
 
+        m_persisted.clear();
         for (const QString &filepath : qAsConst(files)) {
             loadInternal(filepath);
         }
+        m_persistedModificationTime = QFileInfo(m_path).lastModified();
     }
 
 
@@ -214,8 +235,12 @@ namespace SDDM {
                 QStringView value = lineRef.mid(separatorPosition + 1).trimmed();
 
                 auto sectionIterator = m_sections.constFind(currentSection);
-                if (sectionIterator != m_sections.constEnd() && sectionIterator.value()->entry(name))
-                    sectionIterator.value()->entry(name)->setValue(value.toString());
+                if (sectionIterator != m_sections.constEnd() && sectionIterator.value()->entry(name)) {
+                    ConfigEntryBase *entry = sectionIterator.value()->entry(name);
+                    entry->setValue(value.toString());
+                    if (filepath == m_path)
+                        m_persisted.insert(entry, entry->value());
+                }
                 else
                     // if we don't have such member in the config, nag about it
                     m_unusedVariables = true;
@@ -226,7 +251,96 @@ namespace SDDM {
         }
     }
 
+    bool ConfigBase::isPersisted() const {
+        // someone else touched the file, we can't tell what's in there without reading it
+        if (QFileInfo(m_path).lastModified() != m_persistedModificationTime)
+            return false;
+
+        for (const ConfigSection *s : qAsConst(m_sections)) {
+            for (const ConfigEntryBase *b : qAsConst(s->entries())) {
+                auto it = m_persisted.constFind(b);
+                // entries missing from the file are only fine as long as they keep their default
+                if (it == m_persisted.constEnd() ? !b->matchesDefault() : it.value() != b->value())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool ConfigBase::writeFile(const QByteArray &data) const {
+        // follow symlinks so we replace the real file and not the link
+        QString path = QFileInfo(m_path).canonicalFilePath();
+        if (path.isEmpty())
+            path = m_path;
+        const QByteArray target = QFile::encodeName(path);
+
+        // write everything to a sibling first and rename it over the old file,
+        // a crash in between leaves either the old or the new contents behind, never half of it
+        QByteArray tmpPath = target + ".XXXXXX";
+        int fd = mkostemp(tmpPath.data(), O_CLOEXEC);
+        if (fd < 0) {
+            qWarning() << "Failed to create a temporary file for" << path << ":" << strerror(errno);
+            return false;
+        }
+
+        // mkostemp creates the file as 0600, keep what the old one had
+        struct stat st;
+        if (stat(target.constData(), &st) == 0) {
+            fchmod(fd, st.st_mode & 07777);
+            if ((st.st_uid != geteuid() || st.st_gid != getegid()) && fchown(fd, st.st_uid, st.st_gid) != 0)
+                qWarning() << "Failed to keep the ownership of" << path << ":" << strerror(errno);
+        } else {
+            mode_t mask = umask(0);
+            umask(mask);
+            fchmod(fd, 0666 & ~mask);
+        }
+
+        qint64 written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.constData() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                qWarning() << "Failed to write" << path << ":" << strerror(errno);
+                close(fd);
+                unlink(tmpPath.constData());
+                return false;
+            }
+            written += n;
+        }
+
+        if (m_syncPolicy != NoSync && fsync(fd) != 0) {
+            qWarning() << "Failed to sync" << path << ":" << strerror(errno);
+            close(fd);
+            unlink(tmpPath.constData());
+            return false;
+        }
+        close(fd);
+
+        if (rename(tmpPath.constData(), target.constData()) != 0) {
+            qWarning() << "Failed to replace" << path << ":" << strerror(errno);
+            unlink(tmpPath.constData());
+            return false;
+        }
+
+        // make the rename itself durable
+        if (m_syncPolicy == SyncFileAndDirectory) {
+            const QByteArray dir = QFile::encodeName(QFileInfo(path).absolutePath());
+            int dirFd = open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dirFd >= 0) {
+                fsync(dirFd);
+                close(dirFd);
+            }
+        }
+
+        return true;
+    }
+
     void ConfigBase::save(const ConfigSection *section, const ConfigEntryBase *entry) {
+        // nothing changed since the file was last read or written, don't even open it
+        if (isPersisted())
+            return;
+
         // to know if we should overwrite the config or not
         bool changed = false;
         // stores the order of the loaded sections
@@ -350,17 +464,30 @@ namespace SDDM {
 
         // rewrite the whole thing only if there are changes
         if (changed) {
-            file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            QByteArray data;
             for (const ConfigSection *s : sectionOrder)
-                file.write(sectionData.value(s));
+                data.append(sectionData.value(s));
 
             if (sectionData.contains(nullptr)) {
-                file.write("\n");
-                file.write(UNUSED_SECTION_COMMENT);
-                file.write(sectionData.value(nullptr).trimmed());
-                file.write("\n");
+                data.append("\n");
+                data.append(UNUSED_SECTION_COMMENT);
+                data.append(sectionData.value(nullptr).trimmed());
+                data.append("\n");
+            }
+
+            if (!writeFile(data))
+                return;
+        }
+
+        // every entry that was in the file now has its current value, the saved ones were added
+        for (const ConfigSection *s : qAsConst(m_sections)) {
+            for (const ConfigEntryBase *b : qAsConst(s->entries())) {
+                bool saved = !section || (s == section && (!entry || b == entry));
+                if (m_persisted.contains(b) || (saved && !b->matchesDefault()))
+                    m_persisted.insert(b, b->value());
             }
         }
+        m_persistedModificationTime = QFileInfo(m_path).lastModified();
     }
 
     void ConfigBase::wipe() {
@@ -27,6 +27,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QHash>
 
 #define IMPLICIT_SECTION "General"
 #define UNUSED_VARIABLE_COMMENT "# Unused variable"
@@ -186,8 +187,19 @@ namespace SDDM {
     // Base has to be separate from the Config itself - order of initialization
     class ConfigBase {
     public:
+        // how hard save() tries to get the data onto the disk before replacing the old file
+        enum SyncPolicy {
+            NoSync,
+            SyncFile,
+            SyncFileAndDirectory
+        };
+
         ConfigBase(const QString &configPath, const QString &configDir=QString(), const QString &sysConfigDir=QString());
 
+        const QString &path() const;
+        SyncPolicy syncPolicy() const;
+        void setSyncPolicy(SyncPolicy policy);
+
         void load();
         void save(const ConfigSection *section = nullptr, const ConfigEntryBase *entry = nullptr);
         void wipe();
@@ -205,7 +217,14 @@ namespace SDDM {
     private:
         QDateTime dirLatestModifiedTime(const QString &directory);
         void loadInternal(const QString &filepath);
+        bool isPersisted() const;
+        bool writeFile(const QByteArray &data) const;
         QDateTime m_fileModificationTime;
+
+        // values of m_path as last read or written, used to skip saves that wouldn't change anything
+        QHash<const ConfigEntryBase*, QString> m_persisted;
+        QDateTime m_persistedModificationTime;
+        SyncPolicy m_syncPolicy { SyncFile };
     };
 }
 
@@ -48,6 +48,9 @@ namespace SDDM {
         Entry(InputMethod,         QString,     QStringLiteral("qtvirtualkeyboard"),                   _S("Input method module"));
         Entry(Namespaces,          QStringList, QStringList(),                                  _S("Comma-separated list of Linux namespaces for user session to enter"));
         Entry(GreeterEnvironment,  QStringList, QStringList(),                                  _S("Comma-separated list of environment variables to be set"));
+        Entry(StateSync,           SyncPolicy,  SyncFileAndDirectory,                           _S("How hard to make sure the state survives a power cut when it is saved after a login.\n"
+                                                                                                   "Can be directory, file or none. directory syncs the state file and its directory,\n"
+                                                                                                   "file only the file, none leaves it to the kernel"));
         //  Name   Entries (but it's a regular class again)
         Section(Theme,
             Entry(ThemeDir,            QString,     _S(DATA_INSTALL_DIR "/themes"),             _S("Theme directory path"));
@@ -78,7 +81,9 @@ namespace SDDM {
         );
 
         Section(Wayland,
-            Entry(CompositorCommand,   QString,     _S("weston --shell=kiosk"),                 _S("Path of the Wayland compositor to execute when starting the greeter"));
+            Entry(CompositorCommand,   QString,     _S("weston --shell=kiosk"),                 _S("Path of the Wayland compositor to execute when starting the greeter.\n"
+                                                                                                   "If it contains %{fd}, the Wayland socket is created beforehand and %{fd} and %{socket}\n"
+                                                                                                   "are replaced by its file descriptor and name, e.g. \"kwin_wayland --wayland-fd %{fd} --socket %{socket}\""));
             Entry(SessionDir,          QStringList, {_S("/usr/local/share/wayland-sessions"),
                                                      _S("/usr/share/wayland-sessions")},        _S("Comma-separated list of directories containing available Wayland sessions"));
             Entry(SessionCommand,      QString,     _S(WAYLAND_SESSION_COMMAND),                _S("Path to a script to execute when starting the desktop session"));
@@ -138,6 +143,27 @@ namespace SDDM {
             str << "none";
         return str;
     }
+
+    inline QTextStream& operator>>(QTextStream &str, ConfigBase::SyncPolicy &policy) {
+        QString text = str.readLine().trimmed();
+        if (text.compare(QLatin1String("none"), Qt::CaseInsensitive) == 0)
+            policy = ConfigBase::NoSync;
+        else if (text.compare(QLatin1String("file"), Qt::CaseInsensitive) == 0)
+            policy = ConfigBase::SyncFile;
+        else
+            policy = ConfigBase::SyncFileAndDirectory;
+        return str;
+    }
+
+    inline QTextStream& operator<<(QTextStream &str, const ConfigBase::SyncPolicy &policy) {
+        if (policy == ConfigBase::NoSync)
+            str << "none";
+        else if (policy == ConfigBase::SyncFile)
+            str << "file";
+        else
+            str << "directory";
+        return str;
+    }
 }
 
 #endif // SDDM_CONFIGURATION_H
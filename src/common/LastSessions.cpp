@@ -0,0 +1,139 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "LastSessions.h"
+
+#include "Configuration.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace SDDM {
+    // rewrite the file once it has this many lines more than users
+    static const int CompactThreshold = 64;
+
+    LastSessions::LastSessions(const QString &path) : m_path(path) {
+    }
+
+    QString LastSessions::defaultPath() {
+        return QFileInfo(stateConfig.path()).absolutePath() + QStringLiteral("/last-sessions");
+    }
+
+    QString LastSessions::session(uid_t uid) {
+        load();
+        return m_sessions.value(uid);
+    }
+
+    void LastSessions::setSession(uid_t uid, const QString &session) {
+        load();
+
+        if (session.contains(QLatin1Char('\n')) || session.contains(QLatin1Char('\t')))
+            return;
+
+        // an empty session forgets the user
+        auto it = m_sessions.find(uid);
+        if (it != m_sessions.end() ? it.value() == session : session.isEmpty())
+            return;
+        if (session.isEmpty())
+            m_sessions.erase(it);
+        else
+            m_sessions.insert(uid, session);
+
+        // appending to a cut off line would garble the new one too
+        if (m_truncated || m_lines - m_sessions.size() >= CompactThreshold) {
+            compact();
+            return;
+        }
+
+        // it tells who logged into what, only for us to read
+        const int fd = ::open(QFile::encodeName(m_path).constData(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            qWarning() << "Failed to open" << m_path << ":" << strerror(errno);
+            return;
+        }
+        QFile file;
+        if (!file.open(fd, QIODevice::WriteOnly | QIODevice::Append, QFileDevice::AutoCloseHandle)) {
+            qWarning() << "Failed to open" << m_path << ":" << file.errorString();
+            ::close(fd);
+            return;
+        }
+        // a single short write, appends from several displays don't interleave
+        file.write(QByteArray::number(uid) + '\t' + session.toUtf8() + '\n');
+        m_lines++;
+    }
+
+    void LastSessions::load() {
+        if (m_loaded)
+            return;
+        m_loaded = true;
+
+        QFile file(m_path);
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine();
+            m_lines++;
+
+            // the write of the last line didn't make it to the disk completely
+            if (!line.endsWith('\n')) {
+                m_truncated = true;
+                break;
+            }
+
+            int separator = line.indexOf('\t');
+            if (separator <= 0)
+                continue;
+            bool ok = false;
+            uid_t uid = line.left(separator).toUInt(&ok);
+            if (!ok)
+                continue;
+            QString session = QString::fromUtf8(line.mid(separator + 1)).trimmed();
+            if (session.isEmpty())
+                m_sessions.remove(uid);
+            else
+                m_sessions.insert(uid, session);
+        }
+    }
+
+    void LastSessions::compact() {
+        QSaveFile file(m_path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Failed to open" << m_path << ":" << file.errorString();
+            return;
+        }
+        // the new file would get the default permissions if there was none yet
+        file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+        QByteArray data;
+        for (auto it = m_sessions.constBegin(); it != m_sessions.constEnd(); ++it)
+            data += QByteArray::number(it.key()) + '\t' + it.value().toUtf8() + '\n';
+        file.write(data);
+        if (file.commit()) {
+            m_lines = m_sessions.size();
+            m_truncated = false;
+        }
+    }
+}
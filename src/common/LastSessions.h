@@ -0,0 +1,60 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_LASTSESSIONS_H
+#define SDDM_LASTSESSIONS_H
+
+#include <QHash>
+#include <QString>
+
+#include <sys/types.h>
+
+namespace SDDM {
+    /**
+     * Remembers the last session of every user.
+     *
+     * The file is a list of "uid<TAB>session" lines, a login only appends
+     * a line and the last line of a uid wins. It's read once on first use
+     * and compacted when it has grown too much. A last line without its
+     * newline is ignored.
+     */
+    class LastSessions {
+        Q_DISABLE_COPY(LastSessions)
+    public:
+        explicit LastSessions(const QString &path = defaultPath());
+
+        QString session(uid_t uid);
+        void setSession(uid_t uid, const QString &session);
+
+        static QString defaultPath();
+
+    private:
+        void load();
+        void compact();
+
+        QString m_path;
+        QHash<uid_t, QString> m_sessions;
+        int m_lines { 0 };
+        bool m_loaded { false };
+        // the last line lacks its newline
+        bool m_truncated { false };
+    };
+}
+
+#endif // SDDM_LASTSESSIONS_H
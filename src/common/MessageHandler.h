@@ -21,6 +21,7 @@
 #ifndef SDDM_MESSAGEHANDLER_H
 #define SDDM_MESSAGEHANDLER_H
 
+#include "AsyncLogger.h"
 #include "Constants.h"
 
 #include <QDateTime>
@@ -121,11 +122,17 @@ namespace SDDM {
     }
 
     static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &prefix, const QString &msg) {
+        // SDDM_LOG_SINK picks the sink at runtime: journald, file or async
+        if (AsyncLogger::isEnabled()) {
+            AsyncLogger::instance()->log(type, prefix + msg);
+            return;
+        }
 #ifdef HAVE_JOURNALD
+        static const QByteArray sink = qgetenv("SDDM_LOG_SINK");
         // don't log to journald if running interactively, this is likely
         // the case when running sddm in test mode
         static bool isInteractive = isatty(STDERR_FILENO) && qgetenv("USER") != "sddm";
-        if (!isInteractive) {
+        if ((!isInteractive && sink != "file") || sink == "journald") {
             // log to journald
             journaldLogger(type, context, msg);
             return;
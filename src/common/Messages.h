@@ -39,6 +39,8 @@ namespace SDDM {
         LoginSucceeded,
         LoginFailed,
         InformationMessage,
+        PowerActionFinished,
+        Bootstrap,
     };
 
     enum Capability {
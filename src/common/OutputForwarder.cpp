@@ -0,0 +1,139 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "OutputForwarder.h"
+
+#include <QDebug>
+#include <QDir>
+
+namespace SDDM {
+    // per second
+    static const int MaxLines = 200;
+    static const qint64 MaxBytes = 64 * 1024;
+    // longer lines are cut, so a child without newlines can't make us buffer forever
+    static const int MaxLineLength = 4096;
+
+    OutputForwarder::OutputForwarder(QProcess *process, const QString &name)
+        : QObject(process)
+        , m_process(process)
+        , m_name(name) {
+        m_window.start();
+
+        connect(process, &QProcess::readyReadStandardOutput, this, [this] { read(m_stdout); });
+        connect(process, &QProcess::readyReadStandardError, this, [this] { read(m_stderr); });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this] {
+            read(m_stdout);
+            read(m_stderr);
+            flush(m_stdout);
+            flush(m_stderr);
+            reportDropped();
+        });
+
+        const QString logDir = qEnvironmentVariable("SDDM_CHILD_LOG_DIR");
+        if (!logDir.isEmpty())
+            setLogFile(QDir(logDir).filePath(name + QStringLiteral(".log")));
+    }
+
+    void OutputForwarder::setLogFile(const QString &path, qint64 maxSize) {
+        m_file.close();
+        m_file.setFileName(path);
+        m_maxFileSize = maxSize;
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+            qWarning() << "Failed to open" << path << "for the output of" << m_name << ":" << m_file.errorString();
+    }
+
+    quint64 OutputForwarder::droppedLines() const {
+        return m_dropped;
+    }
+
+    void OutputForwarder::read(Channel &channel) {
+        m_process->setReadChannel(channel.channel);
+        channel.pending += m_process->readAll();
+
+        int start = 0;
+        for (int end = channel.pending.indexOf('\n'); end >= 0; end = channel.pending.indexOf('\n', start)) {
+            forward(channel.type, channel.pending.mid(start, qMin(end - start, MaxLineLength)));
+            start = end + 1;
+        }
+        channel.pending.remove(0, start);
+
+        if (channel.pending.size() >= MaxLineLength)
+            flush(channel);
+    }
+
+    void OutputForwarder::flush(Channel &channel) {
+        if (channel.pending.isEmpty())
+            return;
+        forward(channel.type, channel.pending.left(MaxLineLength));
+        channel.pending.clear();
+    }
+
+    void OutputForwarder::forward(QtMsgType type, const QByteArray &line) {
+        if (m_window.elapsed() >= 1000) {
+            reportDropped();
+            m_window.restart();
+            m_windowLines = 0;
+            m_windowBytes = 0;
+        }
+
+        if (m_windowLines >= MaxLines || m_windowBytes + line.size() > MaxBytes) {
+            m_windowDropped++;
+            m_dropped++;
+            return;
+        }
+        m_windowLines++;
+        m_windowBytes += line.size();
+
+        if (m_file.isOpen()) {
+            write(line);
+            return;
+        }
+
+        if (type == QtWarningMsg)
+            qWarning().noquote() << m_name << line;
+        else
+            qInfo().noquote() << m_name << line;
+    }
+
+    void OutputForwarder::write(const QByteArray &line) {
+        // keep a single old copy around
+        if (m_maxFileSize > 0 && m_file.size() + line.size() >= m_maxFileSize) {
+            const QString path = m_file.fileName();
+            m_file.close();
+            QFile::remove(path + QStringLiteral(".1"));
+            QFile::rename(path, path + QStringLiteral(".1"));
+            if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+                return;
+        }
+        m_file.write(line + '\n');
+        m_file.flush();
+    }
+
+    void OutputForwarder::reportDropped() {
+        if (m_windowDropped == 0)
+            return;
+
+        const QString message = QStringLiteral("%1 lines dropped, %2 in total").arg(m_windowDropped).arg(m_dropped);
+        if (m_file.isOpen())
+            write(message.toUtf8());
+        else
+            qWarning().noquote() << m_name << message;
+        m_windowDropped = 0;
+    }
+}
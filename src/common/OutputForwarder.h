@@ -0,0 +1,76 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_OUTPUTFORWARDER_H
+#define SDDM_OUTPUTFORWARDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QProcess>
+
+namespace SDDM {
+    /**
+     * Forwards the stdout and stderr of a child process line by line.
+     *
+     * Only so many lines and bytes per second get through, the rest is
+     * counted and reported as a single line once the next second starts.
+     * If SDDM_CHILD_LOG_DIR is set the lines go to <name>.log in there,
+     * rotated once it grows past 1 MiB, instead of the main log.
+     */
+    class OutputForwarder : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(OutputForwarder)
+    public:
+        explicit OutputForwarder(QProcess *process, const QString &name);
+
+        void setLogFile(const QString &path, qint64 maxSize = 1024 * 1024);
+
+        quint64 droppedLines() const;
+
+    private:
+        struct Channel {
+            QProcess::ProcessChannel channel;
+            QtMsgType type;
+            QByteArray pending;
+        };
+
+        void read(Channel &channel);
+        void flush(Channel &channel);
+        void forward(QtMsgType type, const QByteArray &line);
+        void write(const QByteArray &line);
+        void reportDropped();
+
+        QProcess *m_process { nullptr };
+        QString m_name;
+        Channel m_stdout { QProcess::StandardOutput, QtInfoMsg, { } };
+        Channel m_stderr { QProcess::StandardError, QtWarningMsg, { } };
+
+        QElapsedTimer m_window;
+        int m_windowLines { 0 };
+        qint64 m_windowBytes { 0 };
+        quint64 m_windowDropped { 0 };
+        quint64 m_dropped { 0 };
+
+        QFile m_file;
+        qint64 m_maxFileSize { 0 };
+    };
+}
+
+#endif // SDDM_OUTPUTFORWARDER_H
@@ -0,0 +1,219 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "ProcessReaper.h"
+#include "ProcessSupervisor.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+#include <signal.h>
+
+namespace SDDM {
+    static QPointer<ProcessReaper> s_instance;
+
+    ProcessReaper::ProcessReaper(QObject *parent) : QObject(parent) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ProcessReaper::waitForAll);
+    }
+
+    ProcessReaper *ProcessReaper::instance() {
+        if (!s_instance && QCoreApplication::instance())
+            s_instance = new ProcessReaper(QCoreApplication::instance());
+        return s_instance;
+    }
+
+    bool ProcessReaper::hasEventLoop() {
+        return QCoreApplication::instance() && QThread::currentThread()->loopLevel() > 0;
+    }
+
+    void ProcessReaper::terminate(QProcess *process, int timeout, Callback done) {
+        if (!process || process->state() == QProcess::NotRunning) {
+            if (done)
+                done();
+            return;
+        }
+
+        if (hasEventLoop()) {
+            instance()->start(process, timeout, true, std::move(done));
+            return;
+        }
+
+        process->terminate();
+        if (!process->waitForFinished(timeout)) {
+            process->kill();
+            if (!process->waitForFinished(KillTimeout))
+                qWarning() << "Could not fully finish the process" << process->program();
+        }
+        if (done)
+            done();
+    }
+
+    void ProcessReaper::limit(QProcess *process, int timeout) {
+        if (!process)
+            return;
+
+        if (hasEventLoop()) {
+            ProcessReaper *reaper = instance();
+            if (process->state() == QProcess::NotRunning) {
+                process->deleteLater();
+                return;
+            }
+            reaper->start(process, timeout, false, Callback());
+            adopt(process);
+            return;
+        }
+
+        if (process->state() != QProcess::NotRunning && !process->waitForFinished(timeout)) {
+            process->kill();
+            process->waitForFinished(KillTimeout);
+        }
+        delete process;
+    }
+
+    void ProcessReaper::adopt(QProcess *process) {
+        if (!s_instance || !process)
+            return;
+
+        auto it = s_instance->m_entries.find(process);
+        if (it == s_instance->m_entries.end())
+            return;
+
+        process->setParent(s_instance);
+        it->adopted = true;
+    }
+
+    ProcessSupervisor *ProcessReaper::supervise(QProcess *process) {
+        auto *supervisor = new ProcessSupervisor(process);
+        if (process->state() == QProcess::Running)
+            supervisor->attach(process);
+        // attached again on every start, greeters may be restarted
+        connect(process, &QProcess::started, supervisor, [supervisor, process] {
+            supervisor->attach(process);
+        });
+        return supervisor;
+    }
+
+    void ProcessReaper::waitForAll() {
+        if (!s_instance)
+            return;
+
+        const QList<QProcess *> processes = s_instance->m_entries.keys();
+        for (QProcess *process : processes) {
+            auto it = s_instance->m_entries.constFind(process);
+            if (it == s_instance->m_entries.constEnd())
+                continue;
+
+            // finished() may remove the entry while we wait
+            const QPointer<QProcess> guard = it->process;
+            const int remaining = it->killed ? 0 : qMax(0, it->timer->remainingTime());
+            if (guard && !guard->waitForFinished(remaining)) {
+                guard->kill();
+                if (!guard->waitForFinished(KillTimeout))
+                    qWarning() << "Could not fully finish the process" << guard->program();
+            }
+            s_instance->finish(process);
+        }
+    }
+
+    void ProcessReaper::start(QProcess *process, int timeout, bool terminate, Callback done) {
+        auto it = m_entries.find(process);
+        if (it != m_entries.end()) {
+            if (done)
+                it->callbacks << std::move(done);
+            return;
+        }
+
+        Entry &entry = m_entries[process];
+        entry.process = process;
+        if (done)
+            entry.callbacks << std::move(done);
+
+        entry.timer = new QTimer(this);
+        entry.timer->setSingleShot(true);
+        connect(entry.timer, &QTimer::timeout, this, [this, process] { expired(process); });
+        entry.timer->start(timeout);
+
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, process] { finish(process); });
+        connect(process, &QObject::destroyed, this, [this, process] { finish(process); });
+
+        // signal through a pidfd, and don't SIGKILL a process that already
+        // exited but wasn't reaped by QProcess yet; the one opened when it
+        // started has been pinning the process since then
+        entry.supervisor = process->findChild<ProcessSupervisor *>(QString(), Qt::FindDirectChildrenOnly);
+        if (!entry.supervisor || entry.supervisor->pid() != process->processId()) {
+            entry.supervisor = new ProcessSupervisor(this);
+            entry.ownsSupervisor = true;
+            entry.supervisor->attach(process);
+        }
+
+        if (entry.supervisor->isRunning()) {
+            connect(entry.supervisor, &ProcessSupervisor::exited, entry.timer, &QTimer::stop);
+        } else if (entry.supervisor->pid() == process->processId()) {
+            // it is gone already, QProcess only has to notice
+            entry.timer->stop();
+            return;
+        }
+
+        if (terminate && !entry.supervisor->sendSignal(SIGTERM))
+            process->terminate();
+    }
+
+    void ProcessReaper::expired(QProcess *process) {
+        auto it = m_entries.find(process);
+        if (it == m_entries.end() || !it->process)
+            return;
+
+        if (!it->killed) {
+            qWarning() << it->process->program() << "did not exit in time, killing it";
+            it->killed = true;
+            if (!it->supervisor || !it->supervisor->sendSignal(SIGKILL))
+                it->process->kill();
+            it->timer->start(KillTimeout);
+            return;
+        }
+
+        qWarning() << "Could not fully finish the process" << it->process->program();
+        finish(process);
+    }
+
+    void ProcessReaper::finish(QProcess *process) {
+        auto it = m_entries.find(process);
+        if (it == m_entries.end())
+            return;
+
+        const Entry entry = *it;
+        m_entries.erase(it);
+
+        // we may be called from its timeout
+        entry.timer->deleteLater();
+        if (entry.ownsSupervisor && entry.supervisor)
+            entry.supervisor->deleteLater();
+
+        if (entry.process) {
+            disconnect(entry.process, nullptr, this, nullptr);
+            if (entry.adopted)
+                entry.process->deleteLater();
+        }
+
+        for (const Callback &callback : entry.callbacks)
+            callback();
+    }
+}
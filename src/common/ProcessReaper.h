@@ -0,0 +1,110 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_PROCESSREAPER_H
+#define SDDM_PROCESSREAPER_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+
+#include <functional>
+
+class QTimer;
+
+namespace SDDM {
+    class ProcessSupervisor;
+
+    /**
+     * Terminates child processes without blocking the event loop.
+     *
+     * A process gets SIGTERM right away and SIGKILL once its deadline is
+     * over, the callbacks run as soon as it is gone. Without a running
+     * event loop, e.g. while the application is shutting down, the same
+     * is done synchronously with QProcess::waitForFinished().
+     */
+    class ProcessReaper : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(ProcessReaper)
+    public:
+        using Callback = std::function<void()>;
+
+        // how long to wait after SIGKILL before giving up on a process
+        static const int KillTimeout = 5000;
+
+        /**
+         * Stops @p process, killing it if it is still running after
+         * @p timeout ms. Terminating a process that is already being
+         * terminated only adds @p done to its callbacks.
+         */
+        static void terminate(QProcess *process, int timeout, Callback done = Callback());
+
+        /**
+         * Lets @p process run for at most @p timeout ms before killing it,
+         * and deletes it once it has exited. Meant for short scripts that
+         * nobody is waiting for.
+         */
+        static void limit(QProcess *process, int timeout);
+
+        /**
+         * Takes over a process that is being terminated, for owners that
+         * are destroyed before it exited. It is deleted once it is gone.
+         */
+        static void adopt(QProcess *process);
+
+        /**
+         * Watches @p process through a pidfd from the moment it starts, so
+         * that terminate() signals exactly this process and notices its
+         * exit before QProcess reaps it. Call it before starting the
+         * process; the supervisor is owned by it.
+         */
+        static ProcessSupervisor *supervise(QProcess *process);
+
+        /**
+         * Waits for every pending process, killing those past their
+         * deadline. Runs automatically when the application quits.
+         */
+        static void waitForAll();
+
+    private:
+        struct Entry {
+            QPointer<QProcess> process;
+            QTimer *timer { nullptr };
+            QPointer<ProcessSupervisor> supervisor;
+            bool ownsSupervisor { false };
+            bool killed { false };
+            bool adopted { false };
+            QList<Callback> callbacks;
+        };
+
+        explicit ProcessReaper(QObject *parent);
+
+        static ProcessReaper *instance();
+        static bool hasEventLoop();
+
+        void start(QProcess *process, int timeout, bool terminate, Callback done);
+        void expired(QProcess *process);
+        void finish(QProcess *process);
+
+        QHash<QProcess *, Entry> m_entries;
+    };
+}
+
+#endif // SDDM_PROCESSREAPER_H
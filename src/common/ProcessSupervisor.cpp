@@ -0,0 +1,166 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "ProcessSupervisor.h"
+
+#include <QDebug>
+#include <QProcess>
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+
+namespace SDDM {
+    static int pidfdOpen(pid_t pid) {
+#ifdef SYS_pidfd_open
+        // the descriptor is close-on-exec already
+        return int(::syscall(SYS_pidfd_open, pid, 0));
+#else
+        Q_UNUSED(pid)
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    static int pidfdSendSignal(int pidfd, int signal) {
+#ifdef SYS_pidfd_send_signal
+        return int(::syscall(SYS_pidfd_send_signal, pidfd, signal, nullptr, 0));
+#else
+        Q_UNUSED(pidfd)
+        Q_UNUSED(signal)
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    ProcessSupervisor::ProcessSupervisor(QObject *parent) : QObject(parent) {
+    }
+
+    ProcessSupervisor::~ProcessSupervisor() {
+        release();
+    }
+
+    bool ProcessSupervisor::isSupported() {
+        static const bool supported = [] {
+            const int fd = pidfdOpen(::getpid());
+            if (fd < 0)
+                return false;
+            ::close(fd);
+            return true;
+        }();
+        return supported;
+    }
+
+    bool ProcessSupervisor::attach(QProcess *process) {
+        if (!process || process->state() == QProcess::NotRunning)
+            return false;
+        return open(process->processId(), false);
+    }
+
+    bool ProcessSupervisor::attach(qint64 pid) {
+        return open(pid, true);
+    }
+
+    qint64 ProcessSupervisor::pid() const {
+        return m_pid;
+    }
+
+    bool ProcessSupervisor::isRunning() const {
+        return m_running;
+    }
+
+    int ProcessSupervisor::status() const {
+        return m_status;
+    }
+
+    bool ProcessSupervisor::sendSignal(int signal) {
+        if (!m_running)
+            return false;
+
+        if (m_pidfd >= 0)
+            return pidfdSendSignal(m_pidfd, signal) == 0;
+
+        return ::kill(pid_t(m_pid), signal) == 0;
+    }
+
+    bool ProcessSupervisor::open(qint64 pid, bool reap) {
+        release();
+
+        m_pid = pid;
+        m_reap = reap;
+        m_status = 0;
+        m_running = pid > 0;
+        if (!m_running)
+            return false;
+
+        m_pidfd = pidfdOpen(pid_t(pid));
+        if (m_pidfd < 0) {
+            // the child is gone and already reaped by someone else
+            if (errno == ESRCH)
+                m_running = false;
+            return false;
+        }
+
+        m_notifier = new QSocketNotifier(m_pidfd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &ProcessSupervisor::readable);
+        return true;
+    }
+
+    void ProcessSupervisor::readable() {
+        // the pidfd stays readable from now on
+        m_notifier->setEnabled(false);
+
+        if (m_reap) {
+            // the zombie keeps its PID until it is reaped, so this can't
+            // pick up somebody else's child
+            int status = 0;
+            pid_t result;
+            do {
+                result = ::waitpid(pid_t(m_pid), &status, WNOHANG);
+            } while (result < 0 && errno == EINTR);
+            if (result == pid_t(m_pid))
+                m_status = status;
+            else if (result < 0)
+                qWarning() << "Failed to reap process" << m_pid << ":" << strerror(errno);
+        }
+
+        m_running = false;
+        release();
+        Q_EMIT exited();
+    }
+
+    void ProcessSupervisor::release() {
+        if (m_notifier) {
+            m_notifier->setEnabled(false);
+            m_notifier->deleteLater();
+            m_notifier = nullptr;
+        }
+        if (m_pidfd >= 0) {
+            ::close(m_pidfd);
+            m_pidfd = -1;
+        }
+    }
+}
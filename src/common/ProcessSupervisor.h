@@ -0,0 +1,76 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_PROCESSSUPERVISOR_H
+#define SDDM_PROCESSSUPERVISOR_H
+
+#include <QObject>
+
+class QProcess;
+class QSocketNotifier;
+
+namespace SDDM {
+    /**
+     * Watches a child process through a pidfd.
+     *
+     * The pidfd becomes readable as soon as the process exits, without
+     * depending on SIGCHLD, and signals sent through it can't hit another
+     * process that got the same PID. Children that were forked directly
+     * are reaped here, the ones started by QProcess are left to it.
+     * Without pidfd support signals fall back to kill() and attach()
+     * fails, callers then have to rely on QProcess::finished() or
+     * waitpid() instead.
+     */
+    class ProcessSupervisor : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(ProcessSupervisor)
+    public:
+        explicit ProcessSupervisor(QObject *parent = nullptr);
+        ~ProcessSupervisor();
+
+        static bool isSupported();
+
+        bool attach(QProcess *process);
+        bool attach(qint64 pid);
+
+        qint64 pid() const;
+        bool isRunning() const;
+        // wait status as returned by waitpid(), only for reaped children
+        int status() const;
+
+        bool sendSignal(int signal);
+
+    Q_SIGNALS:
+        void exited();
+
+    private:
+        bool open(qint64 pid, bool reap);
+        void readable();
+        void release();
+
+        qint64 m_pid { -1 };
+        int m_pidfd { -1 };
+        bool m_reap { false };
+        bool m_running { false };
+        int m_status { 0 };
+        QSocketNotifier *m_notifier { nullptr };
+    };
+}
+
+#endif // SDDM_PROCESSSUPERVISOR_H
@@ -75,6 +75,17 @@ namespace SDDM {
         }
     }
 
+    bool SafeDataStream::canReceive() const {
+        qint64 length = -1;
+
+        if (!m_device->isOpen())
+            return false;
+        if (m_device->peek((char*) &length, sizeof(length)) != sizeof(length))
+            return false;
+
+        return m_device->bytesAvailable() >= qint64(sizeof(length)) + qMax(length, qint64(0));
+    }
+
     void SafeDataStream::reset() {
         m_data.clear();
         device()->reset();
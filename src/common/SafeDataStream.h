@@ -30,6 +30,8 @@ namespace SDDM {
         SafeDataStream(QIODevice* device);
         void send();
         void receive();
+        // whether receive() would return without blocking
+        bool canReceive() const;
         void reset();
 
     private:
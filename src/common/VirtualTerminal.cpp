@@ -18,11 +18,20 @@
 ***************************************************************************/
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSocketNotifier>
 #include <QString>
+#include <QTimer>
 
 #include "VirtualTerminal.h"
 
+#include <array>
+#include <memory>
+
 #include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -34,8 +43,6 @@
 #include <linux/kd.h>
 #endif
 #include <sys/ioctl.h>
-#include <qscopeguard.h>
-#include <QFileInfo>
 
 #define RELEASE_DISPLAY_SIGNAL (SIGRTMAX)
 #define ACQUIRE_DISPLAY_SIGNAL (SIGRTMAX - 1)
@@ -50,12 +57,11 @@ namespace SDDM {
             return QStringLiteral("/dev/ttyv%1").arg(c);
         }
 
-        int getVtActive(int fd) {
+        // async-signal-safe
+        static int activeVt(int fd) {
             int vtActive = 0;
-            if (ioctl(fd, VT_GETACTIVE, &vtActive) < 0) {
-                qCritical() << "Failed to get current VT:" << strerror(errno);
+            if (ioctl(fd, VT_GETACTIVE, &vtActive) < 0)
                 return -1;
-            }
             return vtActive;
         }
 #else
@@ -65,29 +71,82 @@ namespace SDDM {
             return QStringLiteral("/dev/tty%1").arg(vt);
         }
 
-        int getVtActive(int fd) {
+        // async-signal-safe
+        static int activeVt(int fd) {
             vt_stat vtState { };
-            if (ioctl(fd, VT_GETSTATE, &vtState) < 0) {
-                qCritical() << "Failed to get current VT:" << strerror(errno);
+            if (ioctl(fd, VT_GETSTATE, &vtState) < 0)
                 return -1;
-            }
             return vtState.v_active;
         }
 #endif
 
+        static int getVtActive(int fd) {
+            const int vtActive = activeVt(fd);
+            if (vtActive < 0)
+                qCritical() << "Failed to get current VT:" << strerror(errno);
+            return vtActive;
+        }
+
+        // VTs we handle switches for in VT_PROCESS mode, kept open so the
+        // signal handlers don't have to open anything
+        static const int s_maxVts = 64;
+        static std::array<int, s_maxVts> s_processFds = [] {
+            std::array<int, s_maxVts> fds;
+            fds.fill(-1);
+            return fds;
+        }();
+
+#ifndef __FreeBSD__
+        // the kernel notifies pollers of this attribute on every VT switch
+        static const char *s_activeAttribute = "/sys/class/tty/tty0/active";
+#endif
+        // how often to check for the switch where we can't be notified, in milliseconds
+        static const int s_pollInterval = 10;
+
+        static void acknowledge(int how) {
+            const int savedErrno = errno;
+
+            // the release is requested while the VT being released is still
+            // active, the acquisition once the acquired one is; any VT we
+            // keep open can tell, unlike the master it needs no open()
+            int vt = -1;
+            for (int fd : s_processFds) {
+                if (fd >= 0) {
+                    vt = activeVt(fd);
+                    break;
+                }
+            }
+            if (vt > 0 && vt < s_maxVts && s_processFds[vt] >= 0)
+                ioctl(s_processFds[vt], VT_RELDISP, how);
+
+            errno = savedErrno;
+        }
+
         static void onAcquireDisplay([[maybe_unused]] int signal) {
-            int fd = open(defaultVtPath, O_RDWR | O_NOCTTY);
-            ioctl(fd, VT_RELDISP, VT_ACKACQ);
-            close(fd);
+            acknowledge(VT_ACKACQ);
         }
 
         static void onReleaseDisplay([[maybe_unused]] int signal) {
-            int fd = open(defaultVtPath, O_RDWR | O_NOCTTY);
-            ioctl(fd, VT_RELDISP, 1);
-            close(fd);
+            acknowledge(1);
+        }
+
+        static int processFd(int vt) {
+            if (vt <= 0 || vt >= s_maxVts)
+                return -1;
+
+            if (s_processFds[vt] < 0) {
+                s_processFds[vt] = open(qPrintable(path(vt)), O_RDWR | O_NOCTTY | O_CLOEXEC);
+                if (s_processFds[vt] < 0)
+                    qWarning("Failed to open %s: %s", qPrintable(path(vt)), strerror(errno));
+            }
+            return s_processFds[vt];
         }
 
-        static bool handleVtSwitches(int fd) {
+        static bool handleVtSwitches(int vt) {
+            const int fd = processFd(vt);
+            if (fd < 0)
+                return false;
+
             vt_mode setModeRequest { };
             bool ok = true;
 
@@ -100,13 +159,25 @@ namespace SDDM {
                 ok = false;
             }
 
-            signal(RELEASE_DISPLAY_SIGNAL, onReleaseDisplay);
-            signal(ACQUIRE_DISPLAY_SIGNAL, onAcquireDisplay);
+            // installed once, the handlers find the VT to acknowledge themselves
+            static bool handlersInstalled = false;
+            if (!handlersInstalled) {
+                struct sigaction action { };
+                sigemptyset(&action.sa_mask);
+                action.sa_flags = SA_RESTART;
+
+                action.sa_handler = onReleaseDisplay;
+                sigaction(RELEASE_DISPLAY_SIGNAL, &action, nullptr);
+                action.sa_handler = onAcquireDisplay;
+                sigaction(ACQUIRE_DISPLAY_SIGNAL, &action, nullptr);
+
+                handlersInstalled = true;
+            }
 
             return ok;
         }
 
-        static void fixVtMode(int fd, bool vt_auto) {
+        static void fixVtMode(int fd, int vt, bool vt_auto) {
             vt_mode getmodeReply { };
             int kernelDisplayMode = 0;
             bool modeFixed = false;
@@ -139,7 +210,7 @@ namespace SDDM {
                 }
             }
             else {
-                ok = handleVtSwitches(fd);
+                ok = handleVtSwitches(vt);
                 modeFixed = true;
             }
 out:
@@ -154,105 +225,204 @@ out:
                 qDebug() << "VT mode didn't need to be fixed";
         }
 
-        int currentVt()
-        {
-            int fd = open(defaultVtPath, O_RDWR | O_NOCTTY);
-            if (fd < 0) {
-                qCritical() << "Failed to open VT master:" << strerror(errno);
+        static int readActive(int fd) {
+            char buffer[16] = { };
+            const ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+            if (n <= 3 || strncmp(buffer, "tty", 3) != 0)
                 return -1;
-            }
-            auto closeFd = qScopeGuard([fd] {
-                close(fd);
-            });
-
-            return getVtActive(fd);
+            return atoi(buffer + 3);
         }
 
-
-        int setUpNewVt() {
-            // open VT master
-            int fd = open(defaultVtPath, O_RDWR | O_NOCTTY);
-            if (fd < 0) {
-                qCritical() << "Failed to open VT master:" << strerror(errno);
-                return -1;
-            }
-            auto closeFd = qScopeGuard([fd] {
-                close(fd);
-            });
-
-            int vt = 0;
-            if (ioctl(fd, VT_OPENQRY, &vt) < 0) {
-                qCritical() << "Failed to open new VT:" << strerror(errno);
-                return -1;
-            }
-
-            // fallback to active VT
-            if (vt <= 0) {
-                int vtActive = getVtActive(fd);
-                qWarning() << "New VT" << vt << "is not valid, fall back to" << vtActive;
-                return vtActive;
-            }
-
-            return vt;
+        static int openActiveWatch() {
+#ifdef __FreeBSD__
+            return -1;
+#else
+            const int fd = open(s_activeAttribute, O_RDONLY | O_CLOEXEC);
+            // reading the attribute arms the notification
+            if (fd >= 0)
+                readActive(fd);
+            return fd;
+#endif
         }
 
-        void jumpToVt(int vt, bool vt_auto) {
-            qDebug() << "Jumping to VT" << vt;
-
-            int fd;
+        static int watchedVt(int watchFd) {
+            return watchFd >= 0 ? readActive(watchFd) : currentVt();
+        }
 
-            int activeVtFd = open(defaultVtPath, O_RDWR | O_NOCTTY);
+        // prepares the VT and asks the kernel to switch to it, without waiting
+        static bool activate(int vt, bool vt_auto) {
+            const int master = openMaster();
+            if (master < 0)
+                return false;
 
-            QString ttyString = path(vt);
-            int vtFd = open(qPrintable(ttyString), O_RDWR | O_NOCTTY);
+            const QString ttyString = path(vt);
+            const int vtFd = vt_auto ? open(qPrintable(ttyString), O_RDWR | O_NOCTTY | O_CLOEXEC) : processFd(vt);
             if (vtFd != -1) {
-                fd = vtFd;
-
                 // Clear VT
-                static const char *clearEscapeSequence = "\33[H\33[2J";
-                if (write(vtFd, clearEscapeSequence, sizeof(clearEscapeSequence)) == -1) {
+                static const char clearEscapeSequence[] = "\33[H\33[2J";
+                if (write(vtFd, clearEscapeSequence, sizeof(clearEscapeSequence) - 1) == -1) {
                     qWarning("Failed to clear VT %d: %s", vt, strerror(errno));
                 }
 
                 // set graphics mode to prevent flickering
-                if (ioctl(fd, KDSETMODE, KD_GRAPHICS) < 0)
+                if (ioctl(vtFd, KDSETMODE, KD_GRAPHICS) < 0)
                     qWarning("Failed to set graphics mode for VT %d: %s", vt, strerror(errno));
 
                 // it's possible that the current VT was left in a broken
                 // combination of states (KD_GRAPHICS with VT_AUTO) that we
                 // cannot switch from, so make sure things are in a way that
-                // will make VT_ACTIVATE work without hanging VT_WAITACTIVE
-                fixVtMode(activeVtFd, vt_auto);
+                // will make VT_ACTIVATE work
+                const int active = getVtActive(master);
+                if (active > 0 && active != vt) {
+                    const int activeFd = open(qPrintable(path(active)), O_RDWR | O_NOCTTY | O_CLOEXEC);
+                    if (activeFd >= 0) {
+                        fixVtMode(activeFd, active, vt_auto);
+                        close(activeFd);
+                    }
+                }
+
+                // If vt_auto is true, the controlling process is already gone, so there is no
+                // process which could send the VT_RELDISP 1 ioctl to release the vt.
+                // Let the kernel switch vts automatically
+                if (vt_auto)
+                    close(vtFd);
+                else
+                    handleVtSwitches(vt);
             } else {
                 qWarning("Failed to open %s: %s", qPrintable(ttyString), strerror(errno));
-                qDebug("Using %s instead of %s!", defaultVtPath, qPrintable(ttyString));
-                fd = activeVtFd;
             }
 
-            // If vt_auto is true, the controlling process is already gone, so there is no
-            // process which could send the VT_RELDISP 1 ioctl to release the vt.
-            // Let the kernel switch vts automatically
-            if (!vt_auto)
-                handleVtSwitches(fd);
+            bool ok = true;
+            while (ioctl(master, VT_ACTIVATE, vt) < 0) {
+                if (errno != EINTR) {
+                    qWarning("Couldn't initiate jump to VT %d: %s", vt, strerror(errno));
+                    ok = false;
+                    break;
+                }
+            }
 
-            do {
-                errno = 0;
+            close(master);
+            return ok;
+        }
 
-                if (ioctl(fd, VT_ACTIVATE, vt) < 0) {
-                    if (errno == EINTR)
-                        continue;
+        int openMaster() {
+            const int fd = open(defaultVtPath, O_RDWR | O_NOCTTY | O_CLOEXEC);
+            if (fd < 0)
+                qCritical() << "Failed to open VT master:" << strerror(errno);
+            return fd;
+        }
 
-                    qWarning("Couldn't initiate jump to VT %d: %s", vt, strerror(errno));
+        int currentVt()
+        {
+            const int fd = openMaster();
+            if (fd < 0)
+                return -1;
+
+            const int vt = getVtActive(fd);
+            close(fd);
+            return vt;
+        }
+
+        bool jumpToVt(int vt, bool vt_auto, int timeout) {
+            qDebug() << "Jumping to VT" << vt;
+
+            QElapsedTimer timer;
+            timer.start();
+
+            // watch before switching, so that the notification can't be missed
+            int watchFd = openActiveWatch();
+            if (!activate(vt, vt_auto)) {
+                if (watchFd >= 0)
+                    close(watchFd);
+                return false;
+            }
+
+            bool ok = true;
+            while (watchedVt(watchFd) != vt) {
+                const qint64 remaining = timeout - timer.elapsed();
+                if (remaining <= 0) {
+                    qWarning("Timed out waiting for the jump to VT %d", vt);
+                    ok = false;
                     break;
                 }
 
-                if (ioctl(fd, VT_WAITACTIVE, vt) < 0 && errno != EINTR)
-                    qWarning("Couldn't finalize jump to VT %d: %s", vt, strerror(errno));
+                if (watchFd >= 0) {
+                    pollfd pfd { watchFd, POLLPRI, 0 };
+                    if (poll(&pfd, 1, int(remaining)) < 0 && errno != EINTR) {
+                        // fall back to checking periodically
+                        close(watchFd);
+                        watchFd = -1;
+                    }
+                } else {
+                    poll(nullptr, 0, int(qMin<qint64>(remaining, s_pollInterval)));
+                }
+            }
+
+            if (watchFd >= 0)
+                close(watchFd);
+
+            if (ok)
+                qDebug("Jumped to VT %d in %lld ms", vt, timer.elapsed());
+            return ok;
+        }
+
+        void jumpToVtAsync(int vt, bool vt_auto, QObject *context,
+                           const std::function<void(bool success, qint64 msecs)> &done,
+                           int timeout) {
+            qDebug() << "Jumping to VT" << vt;
+
+            QElapsedTimer timer;
+            timer.start();
+
+            // watch before switching, so that the notification can't be missed
+            const int watchFd = openActiveWatch();
+            if (!activate(vt, vt_auto)) {
+                if (watchFd >= 0)
+                    close(watchFd);
+                done(false, timer.elapsed());
+                return;
+            }
+
+            // lives until the switch completed or timed out, or context is gone
+            auto *watcher = new QObject(context);
+            QObject::connect(watcher, &QObject::destroyed, [watchFd] {
+                if (watchFd >= 0)
+                    close(watchFd);
+            });
+
+            auto finished = std::make_shared<bool>(false);
+            auto finish = [watcher, finished, vt, timer, done](bool success) {
+                if (*finished)
+                    return;
+                *finished = true;
+
+                if (success)
+                    qDebug("Jumped to VT %d in %lld ms", vt, timer.elapsed());
+                else
+                    qWarning("Timed out waiting for the jump to VT %d", vt);
+
+                done(success, timer.elapsed());
+                watcher->deleteLater();
+            };
+            auto check = [watchFd, vt, finish] {
+                if (watchedVt(watchFd) == vt)
+                    finish(true);
+            };
+
+            if (watchFd >= 0) {
+                auto *notifier = new QSocketNotifier(watchFd, QSocketNotifier::Exception, watcher);
+                QObject::connect(notifier, &QSocketNotifier::activated, watcher, check);
+            } else {
+                auto *pollTimer = new QTimer(watcher);
+                QObject::connect(pollTimer, &QTimer::timeout, watcher, check);
+                pollTimer->start(s_pollInterval);
+            }
+            QTimer::singleShot(timeout, watcher, [finish] {
+                finish(false);
+            });
 
-            } while (errno == EINTR);
-            close(activeVtFd);
-            if (vtFd != -1)
-                close(vtFd);
+            // the switch might be done already
+            check();
         }
     }
 }
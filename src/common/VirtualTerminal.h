@@ -22,14 +22,30 @@
 
 #include <QString>
 
+#include <functional>
+
+class QObject;
+
 namespace SDDM {
     namespace VirtualTerminal {
         extern const char *defaultVtPath;
 
+        // how long a VT switch may take before we give up on it, in milliseconds
+        const int SwitchTimeout = 3000;
+
         QString path(int vt);
+        // opens the VT master for a single operation, the caller closes it;
+        // while open it keeps the VT in the foreground at that time busy
+        int openMaster();
         int currentVt();
-        int setUpNewVt();
-        void jumpToVt(int vt, bool vt_auto);
+
+        // switch and wait up to timeout for the kernel to complete it
+        bool jumpToVt(int vt, bool vt_auto, int timeout = SwitchTimeout);
+        // switch and report completion or timeout from the event loop, done
+        // is called with the result and the switch latency in milliseconds
+        void jumpToVtAsync(int vt, bool vt_auto, QObject *context,
+                           const std::function<void(bool success, qint64 msecs)> &done,
+                           int timeout = SwitchTimeout);
     }
 }
 
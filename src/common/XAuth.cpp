@@ -19,13 +19,14 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 ***************************************************************************/
 
+#include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <QDebug>
 #include <QDir>
-#include <QScopeGuard>
 #include <QString>
 #include <QStringView>
-#include <random>
+#include <sys/random.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -41,6 +42,78 @@
 
 namespace SDDM {
 
+static QByteArray localHostName()
+{
+    // looked up once, the FamilyWild entry still matches after a rename
+    static const QByteArray hostName = [] {
+        char buffer[HOST_NAME_MAX + 1] = "";
+        if (gethostname(buffer, sizeof(buffer)) < 0)
+            return QByteArray("localhost");
+        return QByteArray(buffer);
+    }();
+    return hostName;
+}
+
+static void appendField(QByteArray &record, quint16 value)
+{
+    record.append(char(value >> 8));
+    record.append(char(value & 0xff));
+}
+
+static void appendField(QByteArray &record, const QByteArray &value)
+{
+    appendField(record, quint16(value.size()));
+    record.append(value);
+}
+
+// The two entries written for a display, in the format of XauWriteAuth
+static QByteArray serialize(const QString &display, const QByteArray &cookie)
+{
+    if(display.size() < 2 || display[0] != QLatin1Char(':') || cookie.size() != 16) {
+        qWarning().nospace() << "Unexpected DISPLAY='" << display << "' or cookie.size() = " << cookie.size();
+        return QByteArray();
+    }
+
+    static const QByteArray cookieName("MIT-MAGIC-COOKIE-1");
+
+    // Skip the ':'
+    const QByteArray number = QStringView{display}.mid(1).toUtf8();
+
+    QByteArray record;
+    record.reserve(2 * (10 + number.size() + cookieName.size() + cookie.size()) + localHostName().size());
+
+    appendField(record, quint16(FamilyLocal));
+    appendField(record, localHostName());
+    appendField(record, number);
+    appendField(record, cookieName);
+    appendField(record, cookie);
+
+    // The same entry again, just with FamilyWild
+    appendField(record, quint16(FamilyWild));
+    appendField(record, QByteArray());
+    appendField(record, number);
+    appendField(record, cookieName);
+    appendField(record, cookie);
+
+    return record;
+}
+
+static bool writeAll(int fd, const QByteArray &data)
+{
+    qint64 written = 0;
+    while (written < data.size()) {
+        const ssize_t result = pwrite(fd, data.constData() + written, data.size() - written, written);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            qWarning().nospace() << "pwrite() failed with errno=" << errno;
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
 XAuth::XAuth()
 {
     m_authDir = QStringLiteral(RUNTIME_DIR);
@@ -90,16 +163,17 @@ void XAuth::setup()
     qDebug() << "Xauthority path:" << authPath();
 
     // Generate cookie
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 0xFF);
-
-    m_cookie.truncate(0);
-    m_cookie.reserve(16);
-
-    // Create a random hexadecimal number
-    for(int i = 0; i < 16; i++)
-        m_cookie.append(dis(gen));
+    m_cookie.resize(16);
+    qsizetype filled = 0;
+    while (filled < m_cookie.size()) {
+        const ssize_t result = getrandom(m_cookie.data() + filled, m_cookie.size() - filled, 0);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            qFatal("Failed to generate the xauth cookie");
+        }
+        filled += result;
+    }
 }
 
 bool XAuth::addCookie(const QString &display)
@@ -109,74 +183,46 @@ bool XAuth::addCookie(const QString &display)
         return false;
     }
 
-    return XAuth::writeCookieToFile(display, authPath(), m_cookie);
-}
-
-bool XAuth::writeCookieToFile(const QString &display, const QString &fileName,
-                              QByteArray cookie)
-{
-
-    qDebug() << "Writing cookie to" << fileName;
+    qDebug() << "Writing cookie to" << authPath();
 
-    if(display.size() < 2 || display[0] != QLatin1Char(':') || cookie.size() != 16) {
-        qWarning().nospace() << "Unexpected DISPLAY='" << display << "' or cookie.size() = " << cookie.size();
+    const QByteArray record = serialize(display, m_cookie);
+    if (record.isEmpty())
         return false;
-    }
-
-    // The file needs 0600 permissions
-    const int oldumask = umask(077);
 
-    // Truncate the file. We don't support merging like the xauth tool does.
-    FILE * const authFp = fopen(qPrintable(fileName), "wb");
-    auto error = errno;
-    umask(oldumask);
-    if (authFp == nullptr) {
-        qWarning().nospace() << "fopen() failed with errno=" << error;
+    // Usually only the display number changed, overwrite the file in place
+    const int fd = m_authFile.handle();
+    if (!writeAll(fd, record))
+        return false;
+    if (record.size() < m_record.size() && ftruncate(fd, record.size()) != 0) {
+        qWarning().nospace() << "ftruncate() failed with errno=" << errno;
         return false;
     }
 
-    auto fileCloser = qScopeGuard([authFp]{ fclose(authFp); });
-    char localhost[HOST_NAME_MAX + 1] = "";
-    if (gethostname(localhost, sizeof(localhost)) < 0)
-        strcpy(localhost, "localhost");
+    m_record = record;
+    return true;
+}
 
-    ::Xauth auth = {};
-    char cookieName[] = "MIT-MAGIC-COOKIE-1";
+bool XAuth::writeCookieToFile(const QString &display, const QString &fileName,
+                              QByteArray cookie)
+{
 
-    // Skip the ':'
-    QByteArray displayNumberUtf8 = QStringView{display}.mid(1).toUtf8();
-
-    auth.family = FamilyLocal;
-    auth.address = localhost;
-    auth.address_length = strlen(auth.address);
-    auth.number = displayNumberUtf8.data();
-    auth.number_length = displayNumberUtf8.size();
-    auth.name = cookieName;
-    auth.name_length = sizeof(cookieName) - 1;
-    auth.data = cookie.data();
-    auth.data_length = cookie.size();
-
-    errno = 0;
-    if (XauWriteAuth(authFp, &auth) == 0) {
-        qWarning().nospace() << "XauWriteAuth(FamilyLocal) failed with errno=" << errno;
-        return false;
-    }
+    qDebug() << "Writing cookie to" << fileName;
 
-    // Write the same entry again, just with FamilyWild
-    auth.family = FamilyWild;
-    auth.address_length = 0;
-    errno = 0;
-    if (XauWriteAuth(authFp, &auth) == 0) {
-        qWarning().nospace() << "XauWriteAuth(FamilyWild) failed with errno=" << errno;
+    const QByteArray record = serialize(display, cookie);
+    if (record.isEmpty())
         return false;
-    }
 
-    if (fflush(authFp) != 0) {
-        qWarning().nospace() << "fflush() failed with errno=" << errno;
+    // Truncate the file. We don't support merging like the xauth tool does.
+    // The file needs 0600 permissions.
+    const int fd = open(qPrintable(fileName), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        qWarning().nospace() << "open() failed with errno=" << errno;
         return false;
     }
 
-    return true;
+    const bool success = writeAll(fd, record);
+    close(fd);
+    return success;
 }
 
 } // namespace SDDM
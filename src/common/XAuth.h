@@ -49,6 +49,8 @@ private:
     QString m_authDir;
     QTemporaryFile m_authFile;
     QByteArray m_cookie;
+    // what addCookie() last wrote to m_authFile
+    QByteArray m_record;
 };
 
 } // namespace SDDM
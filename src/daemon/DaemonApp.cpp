@@ -22,14 +22,21 @@
 #include "Configuration.h"
 #include "Constants.h"
 #include "DisplayManager.h"
+#include "Metrics.h"
 #include "PowerManager.h"
 #include "SeatManager.h"
 #include "SignalHandler.h"
+#include "StateWriter.h"
+#include "VirtualTerminalManager.h"
 
 #include "MessageHandler.h"
 
+#include "metricsadaptor.h"
+#include "virtualterminalsadaptor.h"
+
 #include <QDBusConnectionInterface>
 #include <QDebug>
+#include <QFileSystemWatcher>
 #include <QHostInfo>
 #include <QTimer>
 
@@ -50,6 +57,9 @@ namespace SDDM {
         // set testing parameter
         m_testing = (arguments().indexOf(QStringLiteral("--test-mode")) != -1);
 
+        // writes the state of the last login off the main thread
+        m_stateWriter = new StateWriter(this);
+
         bool consoleKitServiceActivatable = false;
         QDBusReply<QStringList> activatableNamesReply = QDBusConnection::systemBus().interface()->activatableServiceNames();
         if (activatableNamesReply.isValid()) {
@@ -65,6 +75,27 @@ namespace SDDM {
             }
         }
 
+        // the host name is sent to every greeter, only look it up when it changes
+        m_hostName = QHostInfo::localHostName();
+        QFileSystemWatcher *hostNameWatcher = new QFileSystemWatcher(this);
+        hostNameWatcher->addPath(QStringLiteral("/etc/hostname"));
+        connect(hostNameWatcher, &QFileSystemWatcher::fileChanged, this, [this, hostNameWatcher](const QString &path) {
+            // editors and hostnamed replace the file, watch the new one
+            if (!hostNameWatcher->files().contains(path))
+                hostNameWatcher->addPath(path);
+            updateHostName();
+        });
+        QDBusConnection::systemBus().connect(QStringLiteral("org.freedesktop.hostname1"), QStringLiteral("/org/freedesktop/hostname1"),
+                                             QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("PropertiesChanged"),
+                                             this, SLOT(updateHostName()));
+
+        // create metrics, before anything that reports to them
+        m_metrics = new Metrics(this);
+        new MetricsAdaptor(m_metrics);
+        // the service itself is registered by the display manager
+        QDBusConnection connection = m_testing ? QDBusConnection::sessionBus() : QDBusConnection::systemBus();
+        connection.registerObject(QStringLiteral("/org/freedesktop/DisplayManager/Metrics"), m_metrics);
+
         // create display manager
         m_displayManager = new DisplayManager(this);
 
@@ -74,6 +105,12 @@ namespace SDDM {
         // create seat manager
         m_seatManager = new SeatManager(this);
 
+        // create virtual terminal manager, after the seat manager so that
+        // it is destroyed after the displays holding VTs
+        m_virtualTerminalManager = new VirtualTerminalManager(this);
+        new VirtualTerminalsAdaptor(m_virtualTerminalManager);
+        connection.registerObject(QStringLiteral("/org/freedesktop/DisplayManager/VirtualTerminals"), m_virtualTerminalManager);
+
         // connect with display manager
         connect(m_seatManager, &SeatManager::seatCreated, m_displayManager, &DisplayManager::AddSeat);
         connect(m_seatManager, &SeatManager::seatRemoved, m_displayManager, &DisplayManager::RemoveSeat);
@@ -87,8 +124,10 @@ namespace SDDM {
         // log message
         qDebug() << "Starting...";
 
-        // initialize seats only after signals are connected
-        m_seatManager->initialize();
+        // initialize seats only after signals are connected, and once the
+        // VTs logind's sessions are on are known, displays ask for one right away
+        connect(m_virtualTerminalManager, &VirtualTerminalManager::ready, m_seatManager, &SeatManager::initialize);
+        m_virtualTerminalManager->watchLoginSessions();
     }
 
     bool DaemonApp::testing() const {
@@ -97,7 +136,19 @@ namespace SDDM {
 
 
     QString DaemonApp::hostName() const {
-        return QHostInfo::localHostName();
+        return m_hostName;
+    }
+
+    void DaemonApp::updateHostName() {
+        const QString hostName = QHostInfo::localHostName();
+        if (hostName == m_hostName)
+            return;
+
+        // log message
+        qDebug() << "Host name changed to" << hostName;
+
+        m_hostName = hostName;
+        emit hostNameChanged(m_hostName);
     }
 
     DisplayManager *DaemonApp::displayManager() const {
@@ -116,6 +167,18 @@ namespace SDDM {
         return m_signalHandler;
     }
 
+    StateWriter *DaemonApp::stateWriter() const {
+        return m_stateWriter;
+    }
+
+    Metrics *DaemonApp::metrics() const {
+        return m_metrics;
+    }
+
+    VirtualTerminalManager *DaemonApp::virtualTerminalManager() const {
+        return m_virtualTerminalManager;
+    }
+
     int DaemonApp::newSessionId() {
         return m_lastSessionId++;
     }
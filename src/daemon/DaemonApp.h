@@ -27,9 +27,12 @@
 namespace SDDM {
     class Configuration;
     class DisplayManager;
+    class Metrics;
     class PowerManager;
     class SeatManager;
     class SignalHandler;
+    class StateWriter;
+    class VirtualTerminalManager;
 
     class DaemonApp : public QCoreApplication {
         Q_OBJECT
@@ -48,20 +51,33 @@ namespace SDDM {
         PowerManager *powerManager() const;
         SeatManager *seatManager() const;
         SignalHandler *signalHandler() const;
+        StateWriter *stateWriter() const;
+        Metrics *metrics() const;
+        VirtualTerminalManager *virtualTerminalManager() const;
 
     public slots:
         int newSessionId();
 
+    signals:
+        void hostNameChanged(const QString &hostName);
+
+    private slots:
+        void updateHostName();
+
     private:
         static DaemonApp *self;
 
         int m_lastSessionId { 0 };
+        QString m_hostName;
 
         bool m_testing { false };
         DisplayManager *m_displayManager { nullptr };
         PowerManager *m_powerManager { nullptr };
         SeatManager *m_seatManager { nullptr };
         SignalHandler *m_signalHandler { nullptr };
+        StateWriter *m_stateWriter { nullptr };
+        Metrics *m_metrics { nullptr };
+        VirtualTerminalManager *m_virtualTerminalManager { nullptr };
     };
 }
 
@@ -21,6 +21,7 @@
 
 #include "Display.h"
 
+#include "AsyncLogger.h"
 #include "Configuration.h"
 #include "DaemonApp.h"
 #include "DisplayManager.h"
@@ -29,13 +30,18 @@
 #include "Seat.h"
 #include "SocketServer.h"
 #include "Greeter.h"
+#include "Metrics.h"
+#include "StateWriter.h"
 #include "Utils.h"
+#include "VirtualTerminalManager.h"
 
 #include <QDebug>
 #include <QFile>
 #include <QTimer>
 #include <QLocalSocket>
 
+#include <memory>
+
 #include <pwd.h>
 #include <unistd.h>
 #include <sys/time.h>
@@ -54,39 +60,8 @@
 #include "config.h"
 
 static int s_ttyFailures = 0;
-#define STRINGIFY(x) #x
 
 namespace SDDM {
-    bool isTtyInUse(const QString &desiredTty) {
-        if (Logind::isAvailable()) {
-            OrgFreedesktopLogin1ManagerInterface manager(Logind::serviceName(), Logind::managerPath(), QDBusConnection::systemBus());
-            auto reply = manager.ListSessions();
-            reply.waitForFinished();
-
-            const auto info = reply.value();
-            for(const SessionInfo &s : info) {
-                OrgFreedesktopLogin1SessionInterface session(Logind::serviceName(), s.sessionPath.path(), QDBusConnection::systemBus());
-                if (desiredTty == session.tTY() && session.state() != QLatin1String("closing")) {
-                    qDebug() << "tty" << desiredTty << "already in use by" << session.user().path.path() << session.state()
-                                      << session.display() << session.desktop() << session.vTNr();
-                    return true;
-                }
-            }
-        }
-        return false;
-    }
-
-    int fetchAvailableVt() {
-        if (!isTtyInUse(QStringLiteral("tty" STRINGIFY(SDDM_INITIAL_VT)))) {
-            return SDDM_INITIAL_VT;
-        }
-        const auto vt = VirtualTerminal::currentVt();
-        if (vt > 0 && !isTtyInUse(QStringLiteral("tty%1").arg(vt))) {
-            return vt;
-        }
-        return VirtualTerminal::setUpNewVt();
-    }
-
     Display::DisplayServerType Display::defaultDisplayServerType()
     {
         const QString &displayServerType = mainConfig.DisplayServer.get().toLower();
@@ -110,6 +85,7 @@ namespace SDDM {
         m_displayServerType(serverType),
         m_auth(new Auth(this)),
         m_seat(parent),
+        m_seatName(parent->name()),
         m_socketServer(new SocketServer(this)),
         m_greeter(new Greeter(this))
     {
@@ -117,20 +93,22 @@ namespace SDDM {
         switch (m_displayServerType) {
         case X11DisplayServerType:
             if (seat()->canTTY()) {
-                m_terminalId = VirtualTerminal::setUpNewVt();
+                m_terminalId = daemonApp->virtualTerminalManager()->acquire(QStringLiteral("%1 display").arg(seat()->name()));
             }
             m_displayServer = new XorgDisplayServer(this);
             break;
         case X11UserDisplayServerType:
             if (seat()->canTTY()) {
-                m_terminalId = fetchAvailableVt();
+                m_terminalId = daemonApp->virtualTerminalManager()->acquire(QStringLiteral("%1 display").arg(seat()->name()),
+                                                                            VirtualTerminalManager::PreferInitialVt);
             }
             m_displayServer = new XorgUserDisplayServer(this);
             m_greeter->setDisplayServerCommand(XorgUserDisplayServer::command(this));
             break;
         case WaylandDisplayServerType:
             if (seat()->canTTY()) {
-                m_terminalId = fetchAvailableVt();
+                m_terminalId = daemonApp->virtualTerminalManager()->acquire(QStringLiteral("%1 display").arg(seat()->name()),
+                                                                            VirtualTerminalManager::PreferInitialVt);
             }
             m_displayServer = new WaylandDisplayServer(this);
             m_greeter->setDisplayServerCommand(mainConfig.Wayland.CompositorCommand.get());
@@ -150,7 +128,7 @@ namespace SDDM {
 
         // restart display after display server ended
         connect(m_displayServer, &DisplayServer::started, this, &Display::displayServerStarted);
-        connect(m_displayServer, &DisplayServer::stopped, this, &Display::stop);
+        connect(m_displayServer, &DisplayServer::stopped, this, &Display::displayServerStopped);
 
         // connect login signal
         connect(m_socketServer, &SocketServer::login, this, &Display::login);
@@ -162,20 +140,39 @@ namespace SDDM {
         connect(m_greeter, &Greeter::failed, this, &Display::stop);
         connect(m_greeter, &Greeter::ttyFailed, this, [this] {
             ++s_ttyFailures;
+            daemonApp->metrics()->count(Metrics::TtyFailures, seat()->name());
             if (s_ttyFailures > 5) {
                 QCoreApplication::exit(23);
             }
             // It might be the case that we are trying a tty that has been taken over by a
             // different process. In such a case, switch back to the initial one and try again.
-            VirtualTerminal::jumpToVt(SDDM_INITIAL_VT, true);
+            daemonApp->virtualTerminalManager()->release(m_terminalId, false);
+            m_terminalId = -1;
+            VirtualTerminal::jumpToVtAsync(SDDM_INITIAL_VT, true, daemonApp, [](bool success, qint64 msecs) {
+                if (success)
+                    daemonApp->metrics()->observe(Metrics::VtSwitchTime, msecs);
+            });
             stop();
         });
         connect(m_greeter, &Greeter::displayServerFailed, this, &Display::displayServerFailed);
+
+        // the greeter is up once it talks to us
+        connect(m_socketServer, &SocketServer::connected, this, [this] {
+            if (!m_greeterTimer.isValid())
+                return;
+            daemonApp->metrics()->observe(Metrics::GreeterStartTime, m_greeterTimer.elapsed());
+            m_greeterTimer.invalidate();
+        });
     }
 
     Display::~Display() {
         disconnect(m_auth, &Auth::finished, this, &Display::slotHelperFinished);
         stop();
+
+        // hand back VTs that weren't already released on stop, processes
+        // that are still being terminated may run on them
+        releaseSessionTerminal(!m_started);
+        daemonApp->virtualTerminalManager()->release(m_terminalId, !m_started);
     }
 
     Display::DisplayServerType Display::displayServerType() const
@@ -205,7 +202,13 @@ namespace SDDM {
     }
 
     bool Display::start() {
-        return m_started || m_displayServer->start();
+        AsyncLogger::Scope logScope(m_seatName, name());
+
+        if (m_started)
+            return true;
+
+        m_displayServerTimer.start();
+        return m_displayServer->start();
     }
 
     bool Display::attemptAutologin() {
@@ -252,6 +255,7 @@ namespace SDDM {
         m_greeter->setTheme(findGreeterTheme());
 
         // start greeter
+        m_greeterTimer.start();
         m_greeter->start();
 
         // reset first flag
@@ -268,10 +272,17 @@ namespace SDDM {
     }
 
     void Display::displayServerStarted() {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         // check flag
         if (m_started)
             return;
 
+        if (m_displayServerTimer.isValid()) {
+            daemonApp->metrics()->observe(Metrics::DisplayServerStartTime, m_displayServerTimer.elapsed());
+            m_displayServerTimer.invalidate();
+        }
+
         // setup display
         m_displayServer->setupDisplay();
 
@@ -297,26 +308,58 @@ namespace SDDM {
     }
 
     void Display::stop() {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         // check flag
-        if (!m_started)
+        if (!m_started || m_stopping)
             return;
 
-        // stop the greeter
-        m_greeter->stop();
-
-        m_auth->stop();
+        // set flag
+        m_stopping = true;
 
         // stop socket server
         m_socketServer->stop();
 
-        // stop display server
-        m_displayServer->blockSignals(true);
+        // the greeter and the session run on the display server, it goes
+        // once both of them are gone
+        auto pending = std::make_shared<int>(2);
+        auto done = [self = QPointer<Display>(this), pending] {
+            if (--*pending == 0 && self)
+                self->stopDisplayServer();
+        };
+        m_greeter->terminate(done);
+        m_auth->terminate(done);
+    }
+
+    void Display::stopDisplayServer() {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
+        // a running server reports back through displayServerStopped()
+        const bool running = m_displayServer->isStarted();
         m_displayServer->stop();
-        m_displayServer->blockSignals(false);
+        if (!running)
+            finishStop();
+    }
+
+    void Display::displayServerStopped() {
+        AsyncLogger::Scope logScope(m_seatName, name());
 
-        // reset flag
+        if (m_stopping)
+            finishStop();
+        else
+            stop();
+    }
+
+    void Display::finishStop() {
+        // reset flags
+        m_stopping = false;
         m_started = false;
 
+        // everything that ran on our VTs has exited, hand them out again
+        releaseSessionTerminal();
+        daemonApp->virtualTerminalManager()->release(m_terminalId);
+        m_terminalId = -1;
+
         // emit signal
         emit stopped();
     }
@@ -324,6 +367,8 @@ namespace SDDM {
     void Display::login(QLocalSocket *socket,
                         const QString &user, const QString &password,
                         const Session &session) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         m_socket = socket;
 
         //the SDDM user has special privileges that skip password checking so that we can load the greeter
@@ -334,6 +379,7 @@ namespace SDDM {
         }
 
         // authenticate
+        m_loginTimer.start();
         startAuth(user, password, session);
     }
 
@@ -424,11 +470,13 @@ namespace SDDM {
         // last session later, in slotAuthenticationFinished()
         m_sessionName = session.fileName();
 
+        // a previous attempt might have reserved one already
+        releaseSessionTerminal();
         m_sessionTerminalId = m_terminalId;
         if ((session.type() == Session::WaylandSession && m_displayServerType == X11DisplayServerType) || (m_greeter->isRunning() && m_displayServerType != X11DisplayServerType)) {
             // Create a new VT when we need to have another compositor running
             if (seat()->canTTY()) {
-                m_sessionTerminalId = VirtualTerminal::setUpNewVt();
+                m_sessionTerminalId = daemonApp->virtualTerminalManager()->acquire(QStringLiteral("%1 session of %2").arg(seat()->name(), user));
             }
         }
 
@@ -466,12 +514,28 @@ namespace SDDM {
             m_auth->setSession(session.exec());
         }
         m_auth->insertEnvironment(env);
+        if (daemonApp->testing())
+            m_auth->setBackend(qEnvironmentVariable("SDDM_AUTH_BACKEND"));
+        m_authTimer.start();
         m_auth->start();
 
         return true;
     }
 
     void Display::slotAuthenticationFinished(const QString &user, bool success) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
+        if (m_authTimer.isValid()) {
+            daemonApp->metrics()->observe(Metrics::PamTime, m_authTimer.elapsed());
+            m_authTimer.invalidate();
+        }
+        if (m_auth->authenticationLatency() >= 0)
+            daemonApp->metrics()->observe(Metrics::HelperAuthTime, m_auth->authenticationLatency());
+        if (!success) {
+            daemonApp->metrics()->count(Metrics::AuthFailures, seat()->name());
+            m_loginTimer.invalidate();
+        }
+
         if (m_auth->autologin() && !success) {
             handleAutologinFailure();
             return;
@@ -499,10 +563,14 @@ namespace SDDM {
                 stateConfig.Last.Session.set(m_sessionName);
             else
                 stateConfig.Last.Session.setDefault();
-            stateConfig.save();
 
             if (m_socket)
                 emit loginSucceeded(m_socket);
+
+            // don't keep the daemon waiting for the disk
+            daemonApp->stateWriter()->saveLogin(m_auth->user(),
+                                                mainConfig.Users.RememberLastSession.get() ? m_sessionName : QString(),
+                                                mainConfig.Users.RememberLastUser.get());
         } else if (m_socket) {
             qDebug() << "Authentication for user " << user << " failed";
             emit loginFailed(m_socket);
@@ -511,6 +579,8 @@ namespace SDDM {
     }
 
     void Display::slotAuthInfo(const QString &message, Auth::Info info) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         qWarning() << "Authentication information:" << info << message;
 
         if (!m_socket)
@@ -520,8 +590,13 @@ namespace SDDM {
     }
 
     void Display::slotAuthError(const QString &message, Auth::Error error) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         qWarning() << "Authentication error:" << error << message;
 
+        if (error == Auth::ERROR_INTERNAL)
+            daemonApp->metrics()->count(Metrics::HelperCrashes, seat()->name());
+
         if (!m_socket)
             return;
 
@@ -530,7 +605,15 @@ namespace SDDM {
             emit loginFailed(m_socket);
     }
 
+    void Display::releaseSessionTerminal(bool reusable) {
+        if (m_sessionTerminalId > 0 && m_sessionTerminalId != m_terminalId)
+            daemonApp->virtualTerminalManager()->release(m_sessionTerminalId, reusable);
+        m_sessionTerminalId = 0;
+    }
+
     void Display::slotHelperFinished(Auth::HelperExitStatus status) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         // Don't restart greeter and display server unless sddm-helper exited
         // with an internal error or the user session finished successfully,
         // we want to avoid greeter from restarting when an authentication
@@ -552,7 +635,19 @@ namespace SDDM {
     }
 
     void Display::slotSessionStarted(bool success) {
+        AsyncLogger::Scope logScope(m_seatName, name());
+
         qDebug() << "Session started" << success;
+        if (m_loginTimer.isValid()) {
+            if (success)
+                daemonApp->metrics()->observe(Metrics::LoginLatency, m_loginTimer.elapsed());
+            if (m_auth->groupLookupTime() >= 0)
+                daemonApp->metrics()->observe(Metrics::GroupLookupTime, m_auth->groupLookupTime());
+            m_loginTimer.invalidate();
+        }
+        // the helper switched to the session's VT, not us
+        if (m_auth->vtSwitchTime() >= 0)
+            daemonApp->metrics()->observe(Metrics::VtSwitchTime, m_auth->vtSwitchTime());
         if (success) {
             QTimer::singleShot(5000, m_greeter, &Greeter::stop);
         }
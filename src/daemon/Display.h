@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QPointer>
 #include <QDir>
+#include <QElapsedTimer>
 
 #include "Auth.h"
 #include "Session.h"
@@ -62,6 +63,7 @@ namespace SDDM {
 
         QString sessionType() const;
         QString reuseSessionId() const { return m_reuseSessionId; }
+        bool isStarted() const { return m_started; }
 
         Seat *seat() const;
 
@@ -91,11 +93,16 @@ namespace SDDM {
 
         void startSocketServerAndGreeter();
         void handleAutologinFailure();
+        void releaseSessionTerminal(bool reusable = true);
+        void stopDisplayServer();
+        void displayServerStopped();
+        void finishStop();
 
         DisplayServerType m_displayServerType = X11DisplayServerType;
 
         bool m_relogin { true };
         bool m_started { false };
+        bool m_stopping { false };
 
         int m_terminalId = -1;
         int m_sessionTerminalId = 0;
@@ -104,9 +111,17 @@ namespace SDDM {
         QString m_sessionName;
         QString m_reuseSessionId;
 
+        // running while the respective step is in flight
+        QElapsedTimer m_displayServerTimer;
+        QElapsedTimer m_greeterTimer;
+        QElapsedTimer m_loginTimer;
+        QElapsedTimer m_authTimer;
+
         Auth *m_auth { nullptr };
         DisplayServer *m_displayServer { nullptr };
         Seat *m_seat { nullptr };
+        // for the log, still valid while the seat is being destroyed
+        const QString m_seatName;
         SocketServer *m_socketServer { nullptr };
         QPointer<QLocalSocket> m_socket;
         Greeter *m_greeter { nullptr };
@@ -33,4 +33,8 @@ namespace SDDM {
     const QString &DisplayServer::display() const {
         return m_display;
     }
+
+    bool DisplayServer::isStarted() const {
+        return m_started;
+    }
 }
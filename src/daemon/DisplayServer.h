@@ -38,6 +38,8 @@ namespace SDDM {
 
         const QString &display() const;
 
+        bool isStarted() const;
+
         virtual QString sessionType() const = 0;
 
     public slots:
@@ -23,6 +23,9 @@
 #include "Constants.h"
 #include "DaemonApp.h"
 #include "DisplayManager.h"
+#include "Metrics.h"
+#include "OutputForwarder.h"
+#include "ProcessReaper.h"
 #include "Seat.h"
 #include "ThemeConfig.h"
 #include "ThemeMetadata.h"
@@ -46,6 +49,7 @@ namespace SDDM {
 
     Greeter::~Greeter() {
         stop();
+        ProcessReaper::adopt(m_process);
 
         delete m_metadata;
         delete m_themeConfig;
@@ -135,14 +139,19 @@ namespace SDDM {
             // delete process on finish
             connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &Greeter::finished);
 
-            connect(m_process, &QProcess::readyReadStandardOutput, this, &Greeter::onReadyReadStandardOutput);
-            connect(m_process, &QProcess::readyReadStandardError, this, &Greeter::onReadyReadStandardError);
+            // forward its output, within limits
+            new OutputForwarder(m_process, QStringLiteral("greeter"));
 
             // log message
             qDebug() << "Greeter starting...";
 
             args << QStringLiteral("--test-mode");
 
+            // let benchmarks stand in for the greeter
+            const QString testGreeter = qEnvironmentVariable("SDDM_TEST_GREETER");
+            if (!testGreeter.isEmpty())
+                greeterPath = testGreeter;
+
             if (m_display->displayServerType() == Display::X11DisplayServerType) {
                 // set process environment
                 QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
@@ -201,6 +210,7 @@ namespace SDDM {
                                    QStringLiteral("LD_LIBRARY_PATH"),
                                    QStringLiteral("QML2_IMPORT_PATH"),
                                    QStringLiteral("QT_PLUGIN_PATH"),
+                                   QStringLiteral("SDDM_LOG_SINK"),
                                    QStringLiteral("XDG_DATA_DIRS")
             }, sysenv, env);
 
@@ -247,22 +257,25 @@ namespace SDDM {
     }
 
     void Greeter::stop() {
+        terminate(nullptr);
+    }
+
+    void Greeter::terminate(const std::function<void()> &done) {
         // check flag
-        if (!m_started)
+        if (!m_started) {
+            if (done)
+                done();
             return;
+        }
 
         // log message
         qDebug() << "Greeter stopping...";
 
         if (daemonApp->testing()) {
-            // terminate process
-            m_process->terminate();
-
-            // wait for finished
-            if (!m_process->waitForFinished(5000))
-                m_process->kill();
+            // terminate process, finished() is called once it is gone
+            ProcessReaper::terminate(m_process, 5000, done);
         } else {
-            m_auth->stop();
+            m_auth->terminate(done);
         }
     }
 
@@ -337,27 +350,15 @@ namespace SDDM {
             || (m_auth && m_auth->isActive());
     }
 
-    void Greeter::onReadyReadStandardError()
-    {
-        if (m_process) {
-            qDebug() << "Greeter errors:" << m_process->readAllStandardError().constData();
-        }
-    }
-
-    void Greeter::onReadyReadStandardOutput()
-    {
-        if (m_process) {
-            qDebug() << "Greeter output:" << m_process->readAllStandardOutput().constData();
-        }
-    }
-
     void Greeter::authInfo(const QString &message, Auth::Info info) {
         Q_UNUSED(info);
         qDebug() << "Information from greeter session:" << message;
     }
 
     void Greeter::authError(const QString &message, Auth::Error error) {
-        Q_UNUSED(error);
         qWarning() << "Error from greeter session:" << message;
+
+        if (error == Auth::ERROR_INTERNAL)
+            daemonApp->metrics()->count(Metrics::HelperCrashes, m_display->seat()->name());
     }
 }
@@ -45,6 +45,9 @@ namespace SDDM {
         void setDisplayServerCommand(const QString &cmd);
         bool isRunning() const;
 
+        // stops the greeter and calls done once it has exited
+        void terminate(const std::function<void()> &done);
+
     public slots:
         bool start();
         void stop();
@@ -55,8 +58,6 @@ namespace SDDM {
         void onSessionStarted(bool success);
         void onDisplayServerReady(const QString &displayName);
         void onHelperFinished(Auth::HelperExitStatus status);
-        void onReadyReadStandardOutput();
-        void onReadyReadStandardError();
         void authInfo(const QString &message, Auth::Info info);
         void authError(const QString &message, Auth::Error error);
 
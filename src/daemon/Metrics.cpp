@@ -0,0 +1,150 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "Metrics.h"
+
+namespace SDDM {
+    // upper bounds of the histogram buckets in milliseconds, the last one catches everything else
+    static const qint64 s_bounds[] = { 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000 };
+    static const int s_boundCount = sizeof(s_bounds) / sizeof(s_bounds[0]);
+
+    static const char *const s_counterNames[] = {
+        "auth_failures",
+        "helper_crashes",
+        "tty_failures",
+        "display_restarts",
+        "x11_user_fallbacks",
+    };
+
+    static const char *const s_histogramNames[] = {
+        "login_latency",
+        "pam_time",
+        "display_server_start_time",
+        "greeter_start_time",
+        "helper_auth_time",
+        "group_lookup_time",
+        "vt_switch_time",
+    };
+
+    static_assert(sizeof(s_counterNames) / sizeof(s_counterNames[0]) == Metrics::CounterCount, "missing counter name");
+    static_assert(sizeof(s_histogramNames) / sizeof(s_histogramNames[0]) == Metrics::HistogramCount, "missing histogram name");
+
+    Metrics::Metrics(QObject *parent) : QObject(parent) {
+        for (Buckets &buckets: m_histograms)
+            buckets.counts.fill(0, s_boundCount + 1);
+    }
+
+    void Metrics::count(Counter counter, const QString &seat) {
+        ++m_counters[counter][seat];
+    }
+
+    void Metrics::observe(Histogram histogram, qint64 msecs) {
+        Buckets &buckets = m_histograms[histogram];
+
+        int i = 0;
+        while (i < s_boundCount && msecs > s_bounds[i])
+            ++i;
+        ++buckets.counts[i];
+        ++buckets.count;
+        buckets.sum += msecs;
+        buckets.max = qMax(buckets.max, msecs);
+    }
+
+    quint64 Metrics::counter(Counter counter, const QString &seat) const {
+        return m_counters[counter].value(seat);
+    }
+
+    quint64 Metrics::total(Counter counter) const {
+        quint64 total = 0;
+        for (quint64 value : m_counters[counter])
+            total += value;
+        return total;
+    }
+
+    qint64 Metrics::percentile(Histogram histogram, int percent) const {
+        const Buckets &buckets = m_histograms[histogram];
+        if (buckets.count == 0)
+            return 0;
+
+        // the upper bound of the bucket the percentile falls into
+        const quint64 rank = (buckets.count * percent + 99) / 100;
+        quint64 seen = 0;
+        for (int i = 0; i < s_boundCount; ++i) {
+            seen += buckets.counts[i];
+            if (seen >= rank)
+                return qMin(s_bounds[i], buckets.max);
+        }
+        return buckets.max;
+    }
+
+    QVariantMap Metrics::GetMetrics() const {
+        QVariantMap metrics;
+
+        for (int i = 0; i < CounterCount; ++i) {
+            const QString name = QString::fromLatin1(s_counterNames[i]);
+            metrics.insert(name, total(Counter(i)));
+            for (auto it = m_counters[i].cbegin(); it != m_counters[i].cend(); ++it)
+                metrics.insert(name + QLatin1Char('.') + it.key(), it.value());
+        }
+
+        for (int i = 0; i < HistogramCount; ++i) {
+            const QString name = QString::fromLatin1(s_histogramNames[i]);
+            const Buckets &buckets = m_histograms[i];
+            metrics.insert(name + QStringLiteral(".count"), buckets.count);
+            metrics.insert(name + QStringLiteral(".sum_ms"), buckets.sum);
+            metrics.insert(name + QStringLiteral(".max_ms"), buckets.max);
+            metrics.insert(name + QStringLiteral(".p50_ms"), percentile(Histogram(i), 50));
+            metrics.insert(name + QStringLiteral(".p95_ms"), percentile(Histogram(i), 95));
+            metrics.insert(name + QStringLiteral(".p99_ms"), percentile(Histogram(i), 99));
+        }
+
+        return metrics;
+    }
+
+    QString Metrics::Scrape() const {
+        QString text;
+
+        for (int i = 0; i < CounterCount; ++i) {
+            const QString name = QStringLiteral("sddm_%1_total").arg(QLatin1String(s_counterNames[i]));
+            text += QStringLiteral("# TYPE %1 counter\n").arg(name);
+            // only a series of its own while nothing was counted at all
+            if (m_counters[i].isEmpty())
+                text += QStringLiteral("%1 0\n").arg(name);
+            for (auto it = m_counters[i].cbegin(); it != m_counters[i].cend(); ++it)
+                text += QStringLiteral("%1{seat=\"%2\"} %3\n").arg(name, it.key()).arg(it.value());
+        }
+
+        for (int i = 0; i < HistogramCount; ++i) {
+            const QString name = QStringLiteral("sddm_%1_seconds").arg(QLatin1String(s_histogramNames[i]));
+            const Buckets &buckets = m_histograms[i];
+            text += QStringLiteral("# TYPE %1 histogram\n").arg(name);
+            quint64 cumulative = 0;
+            for (int j = 0; j < s_boundCount; ++j) {
+                cumulative += buckets.counts[j];
+                text += QStringLiteral("%1_bucket{le=\"%2\"} %3\n").arg(name).arg(s_bounds[j] / 1000.0).arg(cumulative);
+            }
+            text += QStringLiteral("%1_bucket{le=\"+Inf\"} %2\n").arg(name).arg(buckets.count);
+            text += QStringLiteral("%1_sum %2\n").arg(name).arg(buckets.sum / 1000.0);
+            text += QStringLiteral("%1_count %2\n").arg(name).arg(buckets.count);
+        }
+
+        return text;
+    }
+}
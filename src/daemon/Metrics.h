@@ -0,0 +1,89 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#ifndef SDDM_METRICS_H
+#define SDDM_METRICS_H
+
+#include <QHash>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+namespace SDDM {
+    /***************************************************************************
+     * org.freedesktop.DisplayManager.Metrics
+     *
+     * Counters and latency histograms for local monitoring, available as a
+     * dictionary or in the Prometheus text format. DaemonApp puts it on the
+     * bus.
+     **************************************************************************/
+    class Metrics : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(Metrics)
+    public:
+        enum Counter {
+            AuthFailures,
+            HelperCrashes,
+            TtyFailures,
+            DisplayRestarts,
+            X11UserFallbacks,
+            CounterCount
+        };
+
+        enum Histogram {
+            LoginLatency,
+            PamTime,
+            DisplayServerStartTime,
+            GreeterStartTime,
+            HelperAuthTime,
+            GroupLookupTime,
+            VtSwitchTime,
+            HistogramCount
+        };
+
+        explicit Metrics(QObject *parent = nullptr);
+
+        void count(Counter counter, const QString &seat);
+        void observe(Histogram histogram, qint64 msecs);
+
+        quint64 counter(Counter counter, const QString &seat) const;
+        // over all seats
+        quint64 total(Counter counter) const;
+        qint64 percentile(Histogram histogram, int percent) const;
+
+    public slots:
+        QVariantMap GetMetrics() const;
+        QString Scrape() const;
+
+    private:
+        struct Buckets {
+            QVector<quint64> counts;
+            quint64 count { 0 };
+            qint64 sum { 0 };
+            qint64 max { 0 };
+        };
+
+        // per seat name, total() sums them up
+        QHash<QString, quint64> m_counters[CounterCount];
+        Buckets m_histograms[HistogramCount];
+    };
+}
+
+#endif // SDDM_METRICS_H
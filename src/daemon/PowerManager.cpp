@@ -24,29 +24,131 @@
 #include "Messages.h"
 
 #include <QDBusConnectionInterface>
+#include <QDebug>
 #include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
 #include <QDBusReply>
 #include <QProcess>
+#include <QSharedPointer>
+#include <QTimer>
 
 namespace SDDM {
     /************************************************/
     /* POWER MANAGER BACKEND                        */
     /************************************************/
-    class PowerManagerBackend {
+    class PowerManagerBackend : public QObject {
+        Q_OBJECT
     public:
         PowerManagerBackend() {
+            // several signals tend to arrive at once, probe only once for all of them
+            m_refreshTimer.setSingleShot(true);
+            m_refreshTimer.setInterval(100);
+            connect(&m_refreshTimer, &QTimer::timeout, this, &PowerManagerBackend::refresh);
         }
 
         virtual ~PowerManagerBackend() {
         }
 
-        virtual Capabilities capabilities() const = 0;
+        Capabilities capabilities() const {
+            return m_capabilities;
+        }
+
+        virtual void perform(Capability action, const PowerManager::ResultCallback &done) = 0;
+
+    public slots:
+        virtual void refresh() = 0;
+
+        void scheduleRefresh() {
+            m_refreshTimer.start();
+        }
+
+    signals:
+        void capabilitiesChanged();
+
+    protected:
+        // calls all methods at once, a capability is set when its method replies with the expected value
+        void probe(QDBusInterface *interface, Capabilities caps, const QVector<QPair<QString, Capability>> &methods, const QVariant &expected) {
+            const int generation = ++m_generation;
+            auto pending = QSharedPointer<int>::create(methods.size());
+            auto result = QSharedPointer<Capabilities>::create(caps);
+
+            if (methods.isEmpty()) {
+                setCapabilities(caps);
+                return;
+            }
+
+            for (const auto &method : methods) {
+                QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(interface->asyncCall(method.first), this);
+                const Capability capability = method.second;
+                connect(watcher, &QDBusPendingCallWatcher::finished, this, [=]() {
+                    watcher->deleteLater();
+
+                    const QDBusMessage reply = watcher->reply();
+                    if (reply.type() == QDBusMessage::ReplyMessage && reply.arguments().value(0) == expected)
+                        *result |= capability;
+
+                    // a newer probe is running, its result wins
+                    if (--*pending == 0 && generation == m_generation)
+                        setCapabilities(*result);
+                });
+            }
+        }
+
+        // finishes when the call replies, never blocks the event loop
+        void call(QDBusInterface *interface, const QString &method, const QVariantList &args, const PowerManager::ResultCallback &done) {
+            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(interface->asyncCallWithArgumentList(method, args), this);
+            connect(watcher, &QDBusPendingCallWatcher::finished, this, [=]() {
+                watcher->deleteLater();
+
+                if (watcher->isError())
+                    done(false, watcher->error().message());
+                else
+                    done(true, QString());
+            });
+        }
+
+        // finishes when the command exits
+        void run(const QString &commandLine, const PowerManager::ResultCallback &done) {
+            auto command = QProcess::splitCommand(commandLine);
+            if (command.isEmpty()) {
+                done(false, QStringLiteral("No command configured"));
+                return;
+            }
+
+            QProcess *process = new QProcess(this);
+            connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [=](int exitCode, QProcess::ExitStatus exitStatus) {
+                process->deleteLater();
+
+                if (exitStatus != QProcess::NormalExit)
+                    done(false, QStringLiteral("%1 crashed").arg(process->program()));
+                else if (exitCode != 0)
+                    done(false, QStringLiteral("%1 exited with %2").arg(process->program()).arg(exitCode));
+                else
+                    done(true, QString());
+            });
+            connect(process, &QProcess::errorOccurred, this, [=](QProcess::ProcessError error) {
+                // every other error is followed by finished()
+                if (error != QProcess::FailedToStart)
+                    return;
+                process->deleteLater();
+                done(false, process->errorString());
+            });
+
+            const QString program = command.takeFirst();
+            process->start(program, command);
+        }
+
+        void setCapabilities(Capabilities caps) {
+            if (caps == m_capabilities)
+                return;
+            m_capabilities = caps;
+            emit capabilitiesChanged();
+        }
 
-        virtual void powerOff() const = 0;
-        virtual void reboot() const = 0;
-        virtual void suspend() const = 0;
-        virtual void hibernate() const = 0;
-        virtual void hybridSleep() const = 0;
+    private:
+        Capabilities m_capabilities { Capability::None };
+        QTimer m_refreshTimer;
+        int m_generation { 0 };
     };
 
     /**********************************************/
@@ -61,52 +163,39 @@ const QString UPOWER_OBJECT = QStringLiteral("org.freedesktop.UPower");
     public:
         UPowerBackend(const QString & service, const QString & path, const QString & interface) {
             m_interface = new QDBusInterface(service, path, interface, QDBusConnection::systemBus());
+
+            QDBusConnection::systemBus().connect(service, path, QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("PropertiesChanged"), this, SLOT(scheduleRefresh()));
         }
 
         ~UPowerBackend() {
             delete m_interface;
         }
 
-        Capabilities capabilities() const {
-            Capabilities caps = Capability::PowerOff | Capability::Reboot;
-
-            QDBusReply<bool> reply;
-
-            // suspend
-            reply = m_interface->call(QStringLiteral("SuspendAllowed"));
-            if (reply.isValid() && reply.value())
-                caps |= Capability::Suspend;
-
-            // hibernate
-            reply = m_interface->call(QStringLiteral("HibernateAllowed"));
-            if (reply.isValid() && reply.value())
-                caps |= Capability::Hibernate;
-
-            // return capabilities
-            return caps;
-        }
-
-        void powerOff() const {
-            auto command = QProcess::splitCommand(mainConfig.HaltCommand.get());
-            const QString program = command.takeFirst();
-            QProcess::execute(program, command);
-        }
-
-        void reboot() const {
-            auto command = QProcess::splitCommand(mainConfig.RebootCommand.get());
-            const QString program = command.takeFirst();
-            QProcess::execute(program, command);
+        void refresh() {
+            probe(m_interface, Capability::PowerOff | Capability::Reboot, {
+                { QStringLiteral("SuspendAllowed"), Capability::Suspend },
+                { QStringLiteral("HibernateAllowed"), Capability::Hibernate }
+            }, QVariant(true));
         }
 
-        void suspend() const {
-            m_interface->call(QStringLiteral("Suspend"));
-        }
-
-        void hibernate() const {
-            m_interface->call(QStringLiteral("Hibernate"));
-        }
-
-        void hybridSleep() const {
+        void perform(Capability action, const PowerManager::ResultCallback &done) {
+            switch (action) {
+            case Capability::PowerOff:
+                run(mainConfig.HaltCommand.get(), done);
+                break;
+            case Capability::Reboot:
+                run(mainConfig.RebootCommand.get(), done);
+                break;
+            case Capability::Suspend:
+                call(m_interface, QStringLiteral("Suspend"), {}, done);
+                break;
+            case Capability::Hibernate:
+                call(m_interface, QStringLiteral("Hibernate"), {}, done);
+                break;
+            default:
+                done(false, QStringLiteral("Not supported"));
+                break;
+            }
         }
 
     private:
@@ -129,65 +218,50 @@ const QString CK2_OBJECT = QStringLiteral("org.freedesktop.ConsoleKit.Manager");
     public:
         SeatManagerBackend(const QString & service, const QString & path, const QString & interface) {
             m_interface = new QDBusInterface(service, path, interface, QDBusConnection::systemBus());
+
+            // inhibitors and shutdowns change what we are allowed to do
+            QDBusConnection::systemBus().connect(service, path, interface, QStringLiteral("PrepareForShutdown"), this, SLOT(scheduleRefresh()));
+            QDBusConnection::systemBus().connect(service, path, QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("PropertiesChanged"), this, SLOT(scheduleRefresh()));
         }
 
         ~SeatManagerBackend() {
             delete m_interface;
         }
 
-        Capabilities capabilities() const {
-            Capabilities caps = Capability::None;
-
-            QDBusReply<QString> reply;
-
-            // power off
-            reply = m_interface->call(QStringLiteral("CanPowerOff"));
-            if (reply.isValid() && (reply.value() == QLatin1String("yes")))
-                caps |= Capability::PowerOff;
-
-            // reboot
-            reply = m_interface->call(QStringLiteral("CanReboot"));
-            if (reply.isValid() && (reply.value() == QLatin1String("yes")))
-                caps |= Capability::Reboot;
-
-            // suspend
-            reply = m_interface->call(QStringLiteral("CanSuspend"));
-            if (reply.isValid() && (reply.value() == QLatin1String("yes")))
-                caps |= Capability::Suspend;
-
-            // hibernate
-            reply = m_interface->call(QStringLiteral("CanHibernate"));
-            if (reply.isValid() && (reply.value() == QLatin1String("yes")))
-                caps |= Capability::Hibernate;
-
-            // hybrid sleep
-            reply = m_interface->call(QStringLiteral("CanHybridSleep"));
-            if (reply.isValid() && (reply.value() == QLatin1String("yes")))
-                caps |= Capability::HybridSleep;
-
-            // return capabilities
-            return caps;
-        }
-
-        void powerOff() const {
-            m_interface->call(QStringLiteral("PowerOff"), true);
-        }
-
-        void reboot() const {
-            if (!daemonApp->testing())
-                m_interface->call(QStringLiteral("Reboot"), true);
+        void refresh() {
+            probe(m_interface, Capability::None, {
+                { QStringLiteral("CanPowerOff"), Capability::PowerOff },
+                { QStringLiteral("CanReboot"), Capability::Reboot },
+                { QStringLiteral("CanSuspend"), Capability::Suspend },
+                { QStringLiteral("CanHibernate"), Capability::Hibernate },
+                { QStringLiteral("CanHybridSleep"), Capability::HybridSleep }
+            }, QVariant(QStringLiteral("yes")));
         }
 
-        void suspend() const {
-            m_interface->call(QStringLiteral("Suspend"), true);
-        }
+        void perform(Capability action, const PowerManager::ResultCallback &done) {
+            // interactive, polkit may ask for authorization
+            const QVariantList args { true };
 
-        void hibernate() const {
-            m_interface->call(QStringLiteral("Hibernate"), true);
-        }
-
-        void hybridSleep() const {
-            m_interface->call(QStringLiteral("HybridSleep"), true);
+            switch (action) {
+            case Capability::PowerOff:
+                call(m_interface, QStringLiteral("PowerOff"), args, done);
+                break;
+            case Capability::Reboot:
+                call(m_interface, QStringLiteral("Reboot"), args, done);
+                break;
+            case Capability::Suspend:
+                call(m_interface, QStringLiteral("Suspend"), args, done);
+                break;
+            case Capability::Hibernate:
+                call(m_interface, QStringLiteral("Hibernate"), args, done);
+                break;
+            case Capability::HybridSleep:
+                call(m_interface, QStringLiteral("HybridSleep"), args, done);
+                break;
+            default:
+                done(false, QStringLiteral("Not supported"));
+                break;
+            }
         }
 
     private:
@@ -211,6 +285,12 @@ const QString CK2_OBJECT = QStringLiteral("org.freedesktop.ConsoleKit.Manager");
         // check if upower interface exists
         if (interface->isServiceRegistered(UPOWER_SERVICE))
             m_backends << new UPowerBackend(UPOWER_SERVICE, UPOWER_PATH, UPOWER_OBJECT);
+
+        // probe in the background, greeters are told when the answers arrive
+        for (PowerManagerBackend *backend: qAsConst(m_backends)) {
+            connect(backend, &PowerManagerBackend::capabilitiesChanged, this, &PowerManager::updateCapabilities);
+            backend->refresh();
+        }
     }
 
     PowerManager::~PowerManager() {
@@ -219,71 +299,68 @@ const QString CK2_OBJECT = QStringLiteral("org.freedesktop.ConsoleKit.Manager");
     }
 
     Capabilities PowerManager::capabilities() const {
+        return m_capabilities;
+    }
+
+    void PowerManager::updateCapabilities() {
         Capabilities caps = Capability::None;
 
         for (PowerManagerBackend *backend: m_backends)
             caps |= backend->capabilities();
 
-        return caps;
-    }
-
-    void PowerManager::powerOff() const {
-        if (daemonApp->testing())
+        if (caps == m_capabilities)
             return;
 
-        for (PowerManagerBackend *backend: m_backends) {
-            if (backend->capabilities() & Capability::PowerOff) {
-                backend->powerOff();
-                break;
-            }
-        }
-    }
+        // log message
+        qDebug() << "Power capabilities changed:" << caps;
 
-    void PowerManager::reboot() const {
-        if (daemonApp->testing())
-            return;
+        m_capabilities = caps;
+        emit capabilitiesChanged(m_capabilities);
+    }
 
-        for (PowerManagerBackend *backend: m_backends) {
-            if (backend->capabilities() & Capability::Reboot) {
-                backend->reboot();
-                break;
-            }
-        }
+    void PowerManager::powerOff(const ResultCallback &done) {
+        perform(Capability::PowerOff, done);
     }
 
-    void PowerManager::suspend() const {
-        if (daemonApp->testing())
-            return;
+    void PowerManager::reboot(const ResultCallback &done) {
+        perform(Capability::Reboot, done);
+    }
 
-        for (PowerManagerBackend *backend: m_backends) {
-            if (backend->capabilities() & Capability::Suspend) {
-                backend->suspend();
-                break;
-            }
-        }
+    void PowerManager::suspend(const ResultCallback &done) {
+        perform(Capability::Suspend, done);
     }
 
-    void PowerManager::hibernate() const {
-        if (daemonApp->testing())
-            return;
+    void PowerManager::hibernate(const ResultCallback &done) {
+        perform(Capability::Hibernate, done);
+    }
 
-        for (PowerManagerBackend *backend: m_backends) {
-            if (backend->capabilities() & Capability::Hibernate) {
-                backend->hibernate();
-                break;
-            }
-        }
+    void PowerManager::hybridSleep(const ResultCallback &done) {
+        perform(Capability::HybridSleep, done);
     }
 
-    void PowerManager::hybridSleep() const {
-        if (daemonApp->testing())
+    void PowerManager::perform(Capability action, const ResultCallback &done) {
+        // the callback is optional
+        ResultCallback callback = [done](bool success, const QString &errorMessage) {
+            if (!success)
+                qWarning() << "Power action failed:" << errorMessage;
+            if (done)
+                done(success, errorMessage);
+        };
+
+        if (daemonApp->testing()) {
+            callback(false, QStringLiteral("Power actions are disabled in test mode"));
             return;
+        }
 
-        for (PowerManagerBackend *backend: m_backends) {
-            if (backend->capabilities() & Capability::HybridSleep) {
-                backend->hybridSleep();
-                break;
+        for (PowerManagerBackend *backend: qAsConst(m_backends)) {
+            if (backend->capabilities() & action) {
+                backend->perform(action, callback);
+                return;
             }
         }
+
+        callback(false, QStringLiteral("No power backend supports this action"));
     }
 }
+
+#include "PowerManager.moc"
@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QVector>
 
+#include <functional>
+
 #include "Messages.h"
 
 namespace SDDM {
@@ -32,20 +34,33 @@ namespace SDDM {
         Q_OBJECT
         Q_DISABLE_COPY(PowerManager)
     public:
+        // called once the action has been carried out or has failed
+        using ResultCallback = std::function<void(bool success, const QString &errorMessage)>;
+
         PowerManager(QObject *parent = 0);
         ~PowerManager();
 
+        void powerOff(const ResultCallback &done = ResultCallback());
+        void reboot(const ResultCallback &done = ResultCallback());
+        void suspend(const ResultCallback &done = ResultCallback());
+        void hibernate(const ResultCallback &done = ResultCallback());
+        void hybridSleep(const ResultCallback &done = ResultCallback());
+
     public slots:
         Capabilities capabilities() const;
 
-        void powerOff() const;
-        void reboot() const;
-        void suspend() const;
-        void hibernate() const;
-        void hybridSleep() const;
+    signals:
+        void capabilitiesChanged(Capabilities capabilities);
+
+    private slots:
+        void updateCapabilities();
+
+    private:
+        void perform(Capability action, const ResultCallback &done);
 
     private:
         QVector<PowerManagerBackend *> m_backends;
+        Capabilities m_capabilities { Capability::None };
     };
 }
 
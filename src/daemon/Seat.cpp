@@ -20,9 +20,11 @@
 
 #include "Seat.h"
 
+#include "AsyncLogger.h"
 #include "Configuration.h"
 #include "DaemonApp.h"
 #include "Display.h"
+#include "Metrics.h"
 #include "XorgDisplayServer.h"
 #include "VirtualTerminal.h"
 
@@ -47,6 +49,8 @@ namespace SDDM {
     }
 
     void Seat::createDisplay(Display::DisplayServerType serverType) {
+        AsyncLogger::Scope logScope(m_name, QString());
+
         //reload config if needed
         mainConfig.load();
 
@@ -64,6 +68,7 @@ namespace SDDM {
             // since the alternative is a black screen
             if (display->displayServerType() != Display::X11UserDisplayServerType) {
                 qWarning() << "Failed to launch the display server, falling back to DisplayServer=x11-user";
+                daemonApp->metrics()->count(Metrics::X11UserFallbacks, m_name);
                 createDisplay(Display::X11UserDisplayServerType);
             } else if (m_displays.isEmpty()) {
                 qWarning() << "Failed to launch a DisplayServer=x11-user session, aborting";
@@ -102,16 +107,21 @@ namespace SDDM {
         // remove display from list
         m_displays.removeAll(display);
 
-        // stop the display
-        display->blockSignals(true);
-        display->stop();
-        display->blockSignals(false);
+        // it is gone for good, don't restart it once it stopped
+        disconnect(display, &Display::stopped, this, &Seat::displayStopped);
 
-        // delete display
-        display->deleteLater();
+        // delete display once its processes have exited
+        if (display->isStarted()) {
+            connect(display, &Display::stopped, display, &QObject::deleteLater);
+            display->stop();
+        } else {
+            display->deleteLater();
+        }
     }
 
     void Seat::displayStopped() {
+        AsyncLogger::Scope logScope(m_name, QString());
+
         Display *display = qobject_cast<Display *>(sender());
         OrgFreedesktopLogin1ManagerInterface manager(Logind::serviceName(), Logind::managerPath(), QDBusConnection::systemBus());
         std::optional<int> nextVt;
@@ -127,6 +137,7 @@ namespace SDDM {
 
         // restart otherwise
         if (m_displays.isEmpty()) {
+            daemonApp->metrics()->count(Metrics::DisplayRestarts, m_name);
             createDisplay(Display::defaultDisplayServerType());
         }
         // If there is still a session running on some display,
@@ -140,7 +151,10 @@ namespace SDDM {
         }
 
         if (nextVt) {
-            VirtualTerminal::jumpToVt(*nextVt, true);
+            VirtualTerminal::jumpToVtAsync(*nextVt, true, daemonApp, [](bool success, qint64 msecs) {
+                if (success)
+                    daemonApp->metrics()->observe(Metrics::VtSwitchTime, msecs);
+            });
         }
     }
 
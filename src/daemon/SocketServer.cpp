@@ -20,6 +20,7 @@
 
 #include "SocketServer.h"
 
+#include "Configuration.h"
 #include "DaemonApp.h"
 #include "Messages.h"
 #include "PowerManager.h"
@@ -27,9 +28,22 @@
 #include "Utils.h"
 
 #include <QLocalServer>
+#include <QPointer>
 
 namespace SDDM {
+    // tells the greeter how the action went, if it is still around by then
+    static PowerManager::ResultCallback reportTo(QLocalSocket *socket, GreeterMessages action) {
+        QPointer<QLocalSocket> guard(socket);
+        return [guard, action](bool success, const QString &errorMessage) {
+            if (guard)
+                SocketWriter(guard) << quint32(DaemonMessages::PowerActionFinished) << quint32(action) << quint32(success) << errorMessage;
+        };
+    }
+
     SocketServer::SocketServer(QObject *parent) : QObject(parent) {
+        // keep connected greeters up to date
+        connect(daemonApp->powerManager(), &PowerManager::capabilitiesChanged, this, &SocketServer::capabilitiesChanged);
+        connect(daemonApp, &DaemonApp::hostNameChanged, this, &SocketServer::hostNameChanged);
     }
 
     QString SocketServer::socketAddress() const {
@@ -97,6 +111,7 @@ namespace SDDM {
         // connect signals
         connect(socket, &QLocalSocket::readyRead, this, &SocketServer::readyRead);
         connect(socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater);
+        connect(socket, &QObject::destroyed, this, [this, socket] { m_greeters.removeAll(socket); });
     }
 
     void SocketServer::readyRead() {
@@ -121,11 +136,16 @@ namespace SDDM {
                     // log message
                     qDebug() << "Message received from greeter: Connect";
 
-                    // send capabilities
-                    SocketWriter(socket) << quint32(DaemonMessages::Capabilities) << quint32(daemonApp->powerManager()->capabilities());
+                    if (!m_greeters.contains(socket))
+                        m_greeters.append(socket);
 
-                    // send host name
-                    SocketWriter(socket) << quint32(DaemonMessages::HostName) << daemonApp->hostName();
+                    // send everything the greeter shows up front in one go
+                    SocketWriter(socket) << quint32(DaemonMessages::Bootstrap)
+                                         << daemonApp->hostName()
+                                         << quint32(daemonApp->powerManager()->capabilities())
+                                         << stateConfig.Last.User.get()
+                                         << stateConfig.Last.Session.get()
+                                         << quint32(mainConfig.Numlock.get());
 
                     // emit signal
                     emit connected();
@@ -149,7 +169,7 @@ namespace SDDM {
                     qDebug() << "Message received from greeter: PowerOff";
 
                     // power off
-                    daemonApp->powerManager()->powerOff();
+                    daemonApp->powerManager()->powerOff(reportTo(socket, GreeterMessages::PowerOff));
                 }
                 break;
                 case GreeterMessages::Reboot: {
@@ -157,7 +177,7 @@ namespace SDDM {
                     qDebug() << "Message received from greeter: Reboot";
 
                     // reboot
-                    daemonApp->powerManager()->reboot();
+                    daemonApp->powerManager()->reboot(reportTo(socket, GreeterMessages::Reboot));
                 }
                 break;
                 case GreeterMessages::Suspend: {
@@ -165,7 +185,7 @@ namespace SDDM {
                     qDebug() << "Message received from greeter: Suspend";
 
                     // suspend
-                    daemonApp->powerManager()->suspend();
+                    daemonApp->powerManager()->suspend(reportTo(socket, GreeterMessages::Suspend));
                 }
                 break;
                 case GreeterMessages::Hibernate: {
@@ -173,14 +193,14 @@ namespace SDDM {
                     qDebug() << "Message received from greeter: Hibernate";
 
                     // hibernate
-                    daemonApp->powerManager()->hibernate();
+                    daemonApp->powerManager()->hibernate(reportTo(socket, GreeterMessages::Hibernate));
                 }
                 break;
                 case GreeterMessages::HybridSleep: {
                     // log message
                     qDebug() << "Message received from greeter: HybridSleep";
                     // hybrid sleep
-                    daemonApp->powerManager()->hybridSleep();
+                    daemonApp->powerManager()->hybridSleep(reportTo(socket, GreeterMessages::HybridSleep));
                 }
                 break;
                 default: {
@@ -192,6 +212,17 @@ namespace SDDM {
 
     }
 
+    void SocketServer::capabilitiesChanged() {
+        const quint32 capabilities = quint32(daemonApp->powerManager()->capabilities());
+        for (QLocalSocket *socket : qAsConst(m_greeters))
+            SocketWriter(socket) << quint32(DaemonMessages::Capabilities) << capabilities;
+    }
+
+    void SocketServer::hostNameChanged(const QString &hostName) {
+        for (QLocalSocket *socket : qAsConst(m_greeters))
+            SocketWriter(socket) << quint32(DaemonMessages::HostName) << hostName;
+    }
+
     void SocketServer::loginFailed(QLocalSocket *socket) {
         SocketWriter(socket) << quint32(DaemonMessages::LoginFailed);
     }
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QVector>
 
 #include "Session.h"
 
@@ -44,6 +45,8 @@ namespace SDDM {
     private slots:
         void newConnection();
         void readyRead();
+        void capabilitiesChanged();
+        void hostNameChanged(const QString &hostName);
 
     public slots:
         void informationMessage(QLocalSocket *socket, const QString &message);
@@ -58,6 +61,7 @@ namespace SDDM {
 
     private:
         QLocalServer *m_server { nullptr };
+        QVector<QLocalSocket *> m_greeters;
     };
 }
 
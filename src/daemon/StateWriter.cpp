@@ -0,0 +1,111 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "StateWriter.h"
+
+#include "Configuration.h"
+#include "LastSessions.h"
+
+#include <QMutexLocker>
+
+#include <pwd.h>
+#include <unistd.h>
+
+namespace SDDM {
+    StateWriter::StateWriter(QObject *parent) : QObject(parent) {
+        // a copy of its own, the global one is read and updated by the daemon
+        m_state = new StateConfig();
+        // the state is rewritten on every login, make sure a power cut doesn't leave it empty
+        m_state->setSyncPolicy(mainConfig.StateSync.get());
+
+        // per user last session
+        m_lastSessions = new LastSessions();
+
+        m_worker = new QObject();
+        m_worker->moveToThread(&m_thread);
+        connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+        m_thread.setObjectName(QStringLiteral("StateWriter"));
+        m_thread.start(QThread::LowPriority);
+    }
+
+    StateWriter::~StateWriter() {
+        m_thread.quit();
+        m_thread.wait();
+
+        // the thread is gone, write what it didn't get to
+        write();
+
+        delete m_lastSessions;
+        delete m_state;
+    }
+
+    void StateWriter::saveLogin(const QString &user, const QString &session, bool rememberUser) {
+        QMutexLocker locker(&m_mutex);
+
+        m_pending.state = true;
+        m_pending.lastUser = rememberUser ? user : QString();
+        m_pending.lastSession = session;
+
+        // only the last login of every user matters
+        for (int i = 0; i < m_pending.sessions.size(); ++i) {
+            if (m_pending.sessions.at(i).first == user) {
+                m_pending.sessions.remove(i);
+                break;
+            }
+        }
+        m_pending.sessions.append(qMakePair(user, session));
+
+        if (m_scheduled)
+            return;
+        m_scheduled = true;
+        QMetaObject::invokeMethod(m_worker, [this] { write(); }, Qt::QueuedConnection);
+    }
+
+    void StateWriter::write() {
+        Pending pending;
+        {
+            QMutexLocker locker(&m_mutex);
+            pending = m_pending;
+            m_pending = Pending();
+            m_scheduled = false;
+        }
+
+        if (pending.state) {
+            if (pending.lastUser.isEmpty())
+                m_state->Last.User.setDefault();
+            else
+                m_state->Last.User.set(pending.lastUser);
+            if (pending.lastSession.isEmpty())
+                m_state->Last.Session.setDefault();
+            else
+                m_state->Last.Session.set(pending.lastSession);
+            m_state->save();
+        }
+
+        for (const auto &login : qAsConst(pending.sessions)) {
+            // the daemon might be looking up users at the same time
+            struct passwd pwd;
+            struct passwd *result = nullptr;
+            long size = sysconf(_SC_GETPW_R_SIZE_MAX);
+            QByteArray buffer(size > 0 ? int(size) : 16384, Qt::Uninitialized);
+            if (getpwnam_r(qPrintable(login.first), &pwd, buffer.data(), size_t(buffer.size()), &result) == 0 && result)
+                m_lastSessions->setSession(result->pw_uid, login.second);
+        }
+    }
+}
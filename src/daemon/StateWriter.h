@@ -0,0 +1,74 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_STATEWRITER_H
+#define SDDM_STATEWRITER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+
+namespace SDDM {
+    class LastSessions;
+    class StateConfig;
+
+    /**
+     * Writes the state of the last login on a thread of its own.
+     *
+     * state.conf is synced to the disk before it replaces the old file,
+     * which can take a while. Logins only queue their values, and all
+     * that piled up in the meantime goes out in a single write.
+     */
+    class StateWriter : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(StateWriter)
+    public:
+        explicit StateWriter(QObject *parent = nullptr);
+        ~StateWriter();
+
+        // an empty session is forgotten, as is the user unless rememberUser is set
+        void saveLogin(const QString &user, const QString &session, bool rememberUser);
+
+    private:
+        struct Pending {
+            bool state { false };
+            QString lastUser;
+            QString lastSession;
+            // user and session for the last sessions file
+            QVector<QPair<QString, QString>> sessions;
+        };
+
+        void write();
+
+        QThread m_thread;
+        QObject *m_worker { nullptr };
+
+        QMutex m_mutex;
+        Pending m_pending;
+        bool m_scheduled { false };
+
+        // only used on the writer thread
+        StateConfig *m_state { nullptr };
+        LastSessions *m_lastSessions { nullptr };
+    };
+}
+
+#endif // SDDM_STATEWRITER_H
@@ -0,0 +1,330 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "VirtualTerminalManager.h"
+
+#include "LogindDBusTypes.h"
+#include "VirtualTerminal.h"
+#include "config.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDebug>
+
+#include <algorithm>
+#include <memory>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#ifdef __FreeBSD__
+#include <sys/consio.h>
+#else
+#include <linux/vt.h>
+#endif
+
+namespace SDDM {
+    // MAX_NR_CONSOLES on Linux, more than FreeBSD will ever hand out
+    static const int s_maxVts = 63;
+
+    VirtualTerminalManager::VirtualTerminalManager(QObject *parent) : QObject(parent) {
+    }
+
+    VirtualTerminalManager::~VirtualTerminalManager() {
+        for (const Reservation &reservation : qAsConst(m_reservations))
+            closeVt(reservation.fd);
+    }
+
+    int VirtualTerminalManager::acquire(const QString &owner, Preference preference) {
+        // take a single snapshot of logind's view for all candidates
+        const QSet<int> inUse = loginSessionVts();
+        auto available = [this, &inUse](int vt) {
+            return vt > 0 && !m_reservations.contains(vt) && !inUse.contains(vt);
+        };
+
+        if (preference == PreferInitialVt) {
+            if (available(SDDM_INITIAL_VT) && reserve(SDDM_INITIAL_VT, owner))
+                return SDDM_INITIAL_VT;
+
+            const int vt = activeVt();
+            if (available(vt) && reserve(vt, owner))
+                return vt;
+        }
+
+        // hand out released VTs again, lowest first
+        std::sort(m_free.begin(), m_free.end());
+        const QList<int> free = m_free;
+        for (int vt : free) {
+            if (inUse.contains(vt)) {
+                // somebody else took it in the meantime
+                m_free.removeAll(vt);
+                continue;
+            }
+            if (available(vt) && reserve(vt, owner))
+                return vt;
+        }
+
+        const int vt = queryNewVt(inUse, owner);
+        if (vt > 0)
+            return vt;
+
+        // fall back to the active VT when the kernel has no new one
+        const int vtActive = activeVt();
+        if (vtActive > 0 && !m_reservations.contains(vtActive)) {
+            qWarning() << "No new VT available for" << owner << "- falling back to the active VT" << vtActive;
+            if (reserve(vtActive, owner))
+                return vtActive;
+        }
+
+        qCritical() << "Failed to find a VT for" << owner;
+        return -1;
+    }
+
+    void VirtualTerminalManager::release(int vt, bool reusable) {
+        auto it = m_reservations.find(vt);
+        if (it == m_reservations.end())
+            return;
+
+        qDebug() << "Releasing VT" << vt << "held by" << it->owner;
+
+        closeVt(it->fd);
+        m_reservations.erase(it);
+
+        // don't hand out a VT that somebody else took over again
+        if (reusable && !m_free.contains(vt))
+            m_free.append(vt);
+    }
+
+    QString VirtualTerminalManager::owner(int vt) const {
+        return m_reservations.value(vt).owner;
+    }
+
+    void VirtualTerminalManager::watchLoginSessions() {
+        if (!Logind::isAvailable()) {
+            QMetaObject::invokeMethod(this, [this] { setLoginSessions({}); }, Qt::QueuedConnection);
+            return;
+        }
+
+        QDBusConnection bus = QDBusConnection::systemBus();
+        bus.connect(Logind::serviceName(), Logind::managerPath(), Logind::managerIfaceName(), QStringLiteral("SessionNew"), this, SLOT(refreshLoginSessions()));
+        bus.connect(Logind::serviceName(), Logind::managerPath(), Logind::managerIfaceName(), QStringLiteral("SessionRemoved"), this, SLOT(refreshLoginSessions()));
+        refreshLoginSessions();
+    }
+
+    void VirtualTerminalManager::refreshLoginSessions() {
+        // sessions that come and go meanwhile are picked up by another round
+        if (m_refreshing) {
+            m_refreshAgain = true;
+            return;
+        }
+        m_refreshing = true;
+
+        QDBusMessage list = QDBusMessage::createMethodCall(Logind::serviceName(), Logind::managerPath(),
+                                                           Logind::managerIfaceName(), QStringLiteral("ListSessions"));
+        auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(list), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &VirtualTerminalManager::loginSessionsListed);
+    }
+
+    void VirtualTerminalManager::loginSessionsListed(QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+
+        QDBusPendingReply<SessionInfoList> sessions = *watcher;
+        if (sessions.isError()) {
+            qWarning() << "Failed to list login sessions:" << sessions.error().message();
+            setLoginSessions(m_loginSessions);
+            return;
+        }
+
+        const SessionInfoList info = sessions.value();
+        if (info.isEmpty()) {
+            setLoginSessions({});
+            return;
+        }
+
+        // ask for the properties of all sessions at once, one round trip
+        // instead of one per session and property
+        struct Lookup {
+            int pending { 0 };
+            QVector<LoginSession> sessions;
+        };
+        auto lookup = std::make_shared<Lookup>();
+        lookup->pending = info.size();
+
+        QDBusConnection bus = QDBusConnection::systemBus();
+        for (const SessionInfo &s : info) {
+            QDBusMessage getAll = QDBusMessage::createMethodCall(Logind::serviceName(), s.sessionPath.path(),
+                                                                 QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
+            getAll << Logind::sessionIfaceName();
+            auto *propertiesWatcher = new QDBusPendingCallWatcher(bus.asyncCall(getAll), this);
+            connect(propertiesWatcher, &QDBusPendingCallWatcher::finished, this, [this, lookup](QDBusPendingCallWatcher *call) {
+                call->deleteLater();
+
+                QDBusPendingReply<QVariantMap> reply = *call;
+                // the session is gone by now
+                if (!reply.isError()) {
+                    const QVariantMap properties = reply.value();
+
+                    LoginSession session;
+                    session.vt = static_cast<int>(properties.value(QStringLiteral("VTNr")).toUInt());
+                    if (session.vt <= 0) {
+                        // sessions on a tty without a VT number, e.g. started by getty
+                        const QString tty = properties.value(QStringLiteral("TTY")).toString();
+                        if (tty.startsWith(QLatin1String("tty")))
+                            session.vt = QStringView(tty).mid(3).toInt();
+                    }
+                    session.closing = properties.value(QStringLiteral("State")).toString() == QLatin1String("closing");
+                    session.leader = properties.value(QStringLiteral("Leader")).toUInt();
+                    if (session.vt > 0)
+                        lookup->sessions << session;
+                }
+
+                if (--lookup->pending == 0)
+                    setLoginSessions(lookup->sessions);
+            });
+        }
+    }
+
+    void VirtualTerminalManager::setLoginSessions(const QVector<LoginSession> &sessions) {
+        m_loginSessions = sessions;
+        m_refreshing = false;
+
+        if (!m_ready) {
+            m_ready = true;
+            emit ready();
+        }
+
+        if (m_refreshAgain) {
+            m_refreshAgain = false;
+            refreshLoginSessions();
+        }
+    }
+
+    QVariantMap VirtualTerminalManager::GetReservations() const {
+        QVariantMap reservations;
+        for (auto it = m_reservations.cbegin(); it != m_reservations.cend(); ++it) {
+            QVariantMap reservation;
+            reservation.insert(QStringLiteral("owner"), it->owner);
+            reservation.insert(QStringLiteral("since"), it->since.toSecsSinceEpoch());
+            reservations.insert(QStringLiteral("tty%1").arg(it.key()), reservation);
+        }
+        return reservations;
+    }
+
+    QList<int> VirtualTerminalManager::GetFreeVts() const {
+        QList<int> free = m_free;
+        std::sort(free.begin(), free.end());
+        return free;
+    }
+
+    bool VirtualTerminalManager::reserve(int vt, const QString &owner) {
+        // keeping the VT open is what makes the reservation stick: VT_OPENQRY
+        // only returns VTs nobody has open
+        const int fd = openVt(vt);
+        if (fd < 0)
+            return false;
+
+        Reservation reservation;
+        reservation.owner = owner;
+        reservation.since = QDateTime::currentDateTimeUtc();
+        reservation.fd = fd;
+        m_reservations.insert(vt, reservation);
+        m_free.removeAll(vt);
+
+        qDebug() << "Reserved VT" << vt << "for" << owner;
+        return true;
+    }
+
+    int VirtualTerminalManager::queryNewVt(const QSet<int> &inUse, const QString &owner) {
+        // VTs logind knows about but nobody has open are held open while we
+        // look further, otherwise VT_OPENQRY would keep returning them
+        QList<int> skipped;
+        int result = -1;
+
+        for (int i = 0; i < s_maxVts; ++i) {
+            const int vt = nextFreeVt();
+            if (vt <= 0)
+                break;
+
+            if (!inUse.contains(vt) && !m_reservations.contains(vt)) {
+                if (reserve(vt, owner))
+                    result = vt;
+                break;
+            }
+
+            const int skipFd = openVt(vt);
+            if (skipFd < 0)
+                break;
+            skipped.append(skipFd);
+        }
+
+        for (int skipFd : qAsConst(skipped))
+            closeVt(skipFd);
+
+        return result;
+    }
+
+    int VirtualTerminalManager::openVt(int vt) const {
+        const QString path = VirtualTerminal::path(vt);
+        const int fd = open(qPrintable(path), O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (fd < 0)
+            qWarning("Failed to open %s: %s", qPrintable(path), strerror(errno));
+        return fd;
+    }
+
+    void VirtualTerminalManager::closeVt(int fd) const {
+        close(fd);
+    }
+
+    int VirtualTerminalManager::nextFreeVt() const {
+        const int fd = VirtualTerminal::openMaster();
+        if (fd < 0)
+            return -1;
+
+        int vt = 0;
+        if (ioctl(fd, VT_OPENQRY, &vt) < 0) {
+            qCritical() << "Failed to open new VT:" << strerror(errno);
+            vt = -1;
+        }
+        close(fd);
+        return vt;
+    }
+
+    int VirtualTerminalManager::activeVt() const {
+        return VirtualTerminal::currentVt();
+    }
+
+    QSet<int> VirtualTerminalManager::loginSessionVts() const {
+        QSet<int> vts;
+        for (const LoginSession &session : qAsConst(m_loginSessions)) {
+            // a closing session still owns its VT as long as its leader runs
+            if (session.closing) {
+                const pid_t leader = static_cast<pid_t>(session.leader);
+                if (leader <= 0 || (kill(leader, 0) < 0 && errno == ESRCH))
+                    continue;
+            }
+            vts.insert(session.vt);
+        }
+        return vts;
+    }
+}
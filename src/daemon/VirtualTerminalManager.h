@@ -0,0 +1,114 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_VIRTUALTERMINALMANAGER_H
+#define SDDM_VIRTUALTERMINALMANAGER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QVariantMap>
+#include <QVector>
+
+class QDBusPendingCallWatcher;
+
+namespace SDDM {
+    /***************************************************************************
+     * org.freedesktop.DisplayManager.VirtualTerminals
+     *
+     * Hands out VTs to displays and keeps track of who owns them. A reserved
+     * VT is held open until it is released, so VT_OPENQRY won't return it to
+     * anybody else in the meantime, and released VTs are handed out again
+     * before new ones are allocated.
+     *
+     * logind's sessions are looked up asynchronously and kept up to date as
+     * they come and go, acquire() checks the VTs against that snapshot.
+     **************************************************************************/
+    class VirtualTerminalManager : public QObject {
+        Q_OBJECT
+        Q_DISABLE_COPY(VirtualTerminalManager)
+    public:
+        enum Preference {
+            NewVt,
+            PreferInitialVt
+        };
+
+        explicit VirtualTerminalManager(QObject *parent = nullptr);
+        ~VirtualTerminalManager();
+
+        int acquire(const QString &owner, Preference preference = NewVt);
+        void release(int vt, bool reusable = true);
+
+        QString owner(int vt) const;
+
+        // starts following logind's sessions, ready() is emitted once they are known
+        void watchLoginSessions();
+
+    signals:
+        void ready();
+
+    public slots:
+        QVariantMap GetReservations() const;
+        QList<int> GetFreeVts() const;
+
+    protected:
+        // access to the system, tests replace these
+        virtual int openVt(int vt) const;
+        virtual void closeVt(int fd) const;
+        virtual int nextFreeVt() const;
+        virtual int activeVt() const;
+        virtual QSet<int> loginSessionVts() const;
+
+    private slots:
+        void refreshLoginSessions();
+
+    private:
+        struct Reservation {
+            QString owner;
+            QDateTime since;
+            int fd { -1 };
+        };
+
+        struct LoginSession {
+            int vt { -1 };
+            bool closing { false };
+            qint64 leader { 0 };
+        };
+
+        void loginSessionsListed(QDBusPendingCallWatcher *watcher);
+        void setLoginSessions(const QVector<LoginSession> &sessions);
+
+        bool reserve(int vt, const QString &owner);
+        int queryNewVt(const QSet<int> &inUse, const QString &owner);
+
+        QMap<int, Reservation> m_reservations;
+        // released by their owners, handed out again first
+        QList<int> m_free;
+
+        // logind's sessions as of the last refresh
+        QVector<LoginSession> m_loginSessions;
+        bool m_ready { false };
+        bool m_refreshing { false };
+        bool m_refreshAgain { false };
+    };
+}
+
+#endif // SDDM_VIRTUALTERMINALMANAGER_H
@@ -23,6 +23,7 @@
 #include "Configuration.h"
 #include "DaemonApp.h"
 #include "Display.h"
+#include "ProcessReaper.h"
 #include "Seat.h"
 
 #include <QDebug>
@@ -47,6 +48,14 @@ namespace SDDM {
 
     XorgDisplayServer::~XorgDisplayServer() {
         stop();
+
+        // the server may outlive us, still run the stop script once it's gone
+        if (process && m_started) {
+            ProcessReaper::terminate(process, 5000, [display = m_display] {
+                runDisplayStopCommand(display);
+            });
+            ProcessReaper::adopt(process);
+        }
     }
 
     const QString &XorgDisplayServer::display() const {
@@ -80,6 +89,7 @@ namespace SDDM {
 
         // delete process on finish
         connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &XorgDisplayServer::finished);
+        ProcessReaper::supervise(process);
 
         // log message
         qDebug() << "Display server starting...";
@@ -198,14 +208,8 @@ namespace SDDM {
         // log message
         qDebug() << "Display server stopping...";
 
-        // terminate process
-        process->terminate();
-
-        // wait for finished
-        if (!process->waitForFinished(5000)) {
-            process->kill();
-            process->waitForFinished(25000);
-        }
+        // terminate process, finished() is called once it is gone
+        ProcessReaper::terminate(process, 5000);
     }
 
     void XorgDisplayServer::finished() {
@@ -225,6 +229,13 @@ namespace SDDM {
         // log message
         qDebug() << "Display server stopped.";
 
+        runDisplayStopCommand(m_display);
+
+        // emit signal
+        emit stopped();
+    }
+
+    void XorgDisplayServer::runDisplayStopCommand(const QString &display) {
         QStringList displayStopCommand = QProcess::splitCommand(mainConfig.X11.DisplayStopCommand.get());
 
         // create display setup script process
@@ -232,7 +243,7 @@ namespace SDDM {
 
         // set process environment
         QProcessEnvironment env;
-        env.insert(QStringLiteral("DISPLAY"), m_display);
+        env.insert(QStringLiteral("DISPLAY"), display);
         env.insert(QStringLiteral("HOME"), QStringLiteral("/"));
         env.insert(QStringLiteral("PATH"), mainConfig.Users.DefaultPath.get());
         env.insert(QStringLiteral("SHELL"), QStringLiteral("/bin/sh"));
@@ -243,16 +254,8 @@ namespace SDDM {
         const auto program = displayStopCommand.takeFirst();
         displayStopScript->start(program, displayStopCommand);
 
-        // wait for finished
-        if (!displayStopScript->waitForFinished(5000))
-            displayStopScript->kill();
-
-        // clean up the script process
-        displayStopScript->deleteLater();
-        displayStopScript = nullptr;
-
-        // emit signal
-        emit stopped();
+        // give it 5 seconds, it is deleted once it is done
+        ProcessReaper::limit(displayStopScript, 5000);
     }
 
     void XorgDisplayServer::setupDisplay() {
@@ -53,6 +53,7 @@ namespace SDDM {
         QProcess *process { nullptr };
 
         void changeOwner(const QString &fileName);
+        static void runDisplayStopCommand(const QString &display);
     };
 }
 
@@ -0,0 +1,177 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "BackgroundCache.h"
+#include "CacheFile.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+#include <string.h>
+
+namespace SDDM {
+    // bump when the layout of the cache files changes
+    static const quint32 s_version = 2;
+    static const char s_magic[8] = { 'S', 'D', 'D', 'M', 'B', 'G', 'I', 'M' };
+
+    // followed by the scan lines
+    struct BackgroundCache::Header {
+        quint32 format;
+        qint32 width;
+        qint32 height;
+        quint32 reserved;
+        qint64 bytesPerLine;
+    };
+
+    static void closeCacheFile(void *file) {
+        delete static_cast<CacheFile *>(file);
+    }
+
+    BackgroundCache::BackgroundCache(const QString &directory) : m_directory(directory) {
+    }
+
+    BackgroundCache::~BackgroundCache() {
+    }
+
+    QString BackgroundCache::defaultDirectory() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/backgrounds");
+    }
+
+    QImage BackgroundCache::image(const QString &fileName, const QSize &size) {
+        QMutexLocker locker(&m_mutex);
+
+        // one image per source, another size replaces it
+        auto it = m_images.constFind(fileName);
+        if (it != m_images.constEnd() && it->size == size)
+            return it->image;
+
+        const QFileInfo source(fileName);
+        if (!source.exists()) {
+            qWarning() << "Cannot find the background" << fileName;
+            return QImage();
+        }
+
+        // resources can't change, no point in caching them on disk
+        const bool persistent = !fileName.startsWith(QLatin1Char(':')) && !m_directory.isEmpty();
+        const QString cacheFile = persistent ? cacheFileName(fileName, size) : QString();
+
+        QImage image = persistent ? load(cacheFile, source) : QImage();
+        if (persistent)
+            m_used.insert(cacheFile);
+        if (image.isNull()) {
+            image = decode(fileName, size);
+            if (image.isNull())
+                return image;
+            if (persistent) {
+                save(cacheFile, source, image);
+                removeStale(fileName);
+            }
+        }
+
+        m_images.insert(fileName, { size, image });
+        return image;
+    }
+
+    QString BackgroundCache::sourceKey(const QString &fileName) {
+        return QString::fromLatin1(QCryptographicHash::hash(fileName.toUtf8(), QCryptographicHash::Sha1).toHex());
+    }
+
+    QString BackgroundCache::cacheFileName(const QString &fileName, const QSize &size) const {
+        // all copies of a source share the prefix, so they can be found again
+        return m_directory + QLatin1Char('/') + sourceKey(fileName)
+                + QStringLiteral("-%1x%2.img").arg(size.width()).arg(size.height());
+    }
+
+    QImage BackgroundCache::load(const QString &cacheFile, const QFileInfo &source) const {
+        CacheFile *file = new CacheFile(cacheFile, s_magic, s_version);
+        if (!file->map(source) || file->size() < qint64(sizeof(Header))) {
+            delete file;
+            return QImage();
+        }
+
+        const uchar *data = file->data();
+        Header header;
+        memcpy(&header, data, sizeof(header));
+
+        const bool valid = (header.format == QImage::Format_RGB32 || header.format == QImage::Format_ARGB32_Premultiplied)
+                && header.width > 0 && header.height > 0
+                && header.bytesPerLine >= qint64(header.width) * 4
+                && qint64(sizeof(Header)) + header.bytesPerLine * header.height == file->size();
+        if (!valid) {
+            delete file;
+            return QImage();
+        }
+
+        // the image uses the mapping directly, the file is closed with the last copy
+        return QImage(data + sizeof(Header), header.width, header.height, int(header.bytesPerLine),
+                      QImage::Format(header.format), closeCacheFile, file);
+    }
+
+    QImage BackgroundCache::decode(const QString &fileName, const QSize &size) const {
+        QImageReader reader(fileName);
+
+        // let the reader scale, JPEG in particular only decodes what it needs
+        const QSize sourceSize = reader.size();
+        if (sourceSize.isValid() && size.isValid()) {
+            const QSize scaledSize = sourceSize.scaled(size, Qt::KeepAspectRatioByExpanding);
+            if (scaledSize.width() < sourceSize.width())
+                reader.setScaledSize(scaledSize);
+        }
+
+        QImage image = reader.read();
+        if (image.isNull()) {
+            qWarning() << "Failed to read the background" << fileName << reader.errorString();
+            return image;
+        }
+
+        // what the scene graph uploads without another conversion
+        return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    }
+
+    void BackgroundCache::save(const QString &cacheFile, const QFileInfo &source, const QImage &image) const {
+        Header header;
+        header.format = quint32(image.format());
+        header.width = image.width();
+        header.height = image.height();
+        header.reserved = 0;
+        header.bytesPerLine = image.bytesPerLine();
+
+        // the pixels aren't copied, only written out
+        CacheFile(cacheFile, s_magic, s_version).write(source, {
+            QByteArray::fromRawData(reinterpret_cast<const char *>(&header), int(sizeof(header))),
+            QByteArray::fromRawData(reinterpret_cast<const char *>(image.constBits()), int(image.sizeInBytes()))
+        });
+    }
+
+    void BackgroundCache::removeStale(const QString &fileName) const {
+        // copies at sizes no screen asked for since we started
+        const QDir dir(m_directory);
+        const QStringList names = dir.entryList({ sourceKey(fileName) + QStringLiteral("-*.img") }, QDir::Files);
+        for (const QString &name : names) {
+            const QString cacheFile = m_directory + QLatin1Char('/') + name;
+            if (!m_used.contains(cacheFile))
+                QFile::remove(cacheFile);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_BACKGROUNDCACHE_H
+#define SDDM_BACKGROUNDCACHE_H
+
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#include <QSize>
+#include <QString>
+
+namespace SDDM {
+    /**
+     * Background images decoded at the size of the screen.
+     *
+     * Every image is decoded once per size and shared by all the views
+     * asking for it, only the last size asked for is kept in memory. A copy
+     * of the scaled pixels is kept in the cache directory and mapped on the
+     * next start, so unless the source file changes it is never decoded
+     * again. Copies at sizes no longer used are removed once a new one has
+     * been written.
+     */
+    class BackgroundCache {
+    public:
+        explicit BackgroundCache(const QString &directory);
+        ~BackgroundCache();
+
+        static QString defaultDirectory();
+
+        // fileName scaled to cover size, keeping its aspect ratio
+        QImage image(const QString &fileName, const QSize &size);
+
+    private:
+        struct Header;
+        struct Entry {
+            QSize size;
+            QImage image;
+        };
+
+        static QString sourceKey(const QString &fileName);
+        QString cacheFileName(const QString &fileName, const QSize &size) const;
+        QImage load(const QString &cacheFile, const QFileInfo &source) const;
+        QImage decode(const QString &fileName, const QSize &size) const;
+        void save(const QString &cacheFile, const QFileInfo &source, const QImage &image) const;
+        void removeStale(const QString &fileName) const;
+
+        QString m_directory;
+
+        // the theme might load images asynchronously
+        QMutex m_mutex;
+        // by source file
+        QHash<QString, Entry> m_images;
+        // cache files this process uses, the others are stale
+        QSet<QString> m_used;
+    };
+}
+
+#endif // SDDM_BACKGROUNDCACHE_H
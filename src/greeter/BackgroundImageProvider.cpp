@@ -0,0 +1,63 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "BackgroundImageProvider.h"
+
+#include "BackgroundCache.h"
+
+#include <QDebug>
+#include <QUrl>
+
+namespace SDDM {
+    BackgroundImageProvider::BackgroundImageProvider(BackgroundCache *cache)
+        : QQuickImageProvider(QQuickImageProvider::Image)
+        , m_cache(cache)
+    {
+    }
+
+    QImage BackgroundImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+    {
+        const int separator = id.indexOf(QLatin1Char('/'));
+        const QString screenSize = id.left(separator);
+        const QUrl url(QUrl::fromPercentEncoding(id.mid(separator + 1).toUtf8()));
+
+        // the screen size, unless the theme asks for something else
+        QSize targetSize = requestedSize;
+        if (targetSize.isEmpty()) {
+            const int x = screenSize.indexOf(QLatin1Char('x'));
+            targetSize = QSize(screenSize.left(x).toInt(), screenSize.mid(x + 1).toInt());
+        }
+
+        QString fileName;
+        if (url.isLocalFile())
+            fileName = url.toLocalFile();
+        else if (url.scheme() == QLatin1String("qrc"))
+            fileName = QLatin1Char(':') + url.path();
+
+        if (separator < 0 || fileName.isEmpty()) {
+            qWarning() << "Invalid background" << id;
+            return QImage();
+        }
+
+        const QImage image = m_cache->image(fileName, targetSize);
+        if (size)
+            *size = image.size();
+        return image;
+    }
+}
@@ -0,0 +1,45 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_BACKGROUNDIMAGEPROVIDER_H
+#define SDDM_BACKGROUNDIMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+
+namespace SDDM {
+    class BackgroundCache;
+
+    /**
+     * image://sddm-background/<width>x<height>/<percent encoded url>
+     *
+     * Every engine takes ownership of its provider, the cache behind them
+     * is shared by all views.
+     */
+    class BackgroundImageProvider : public QQuickImageProvider {
+    public:
+        explicit BackgroundImageProvider(BackgroundCache *cache);
+
+        QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    private:
+        BackgroundCache *m_cache { nullptr };
+    };
+}
+
+#endif // SDDM_BACKGROUNDIMAGEPROVIDER_H
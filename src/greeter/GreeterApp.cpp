@@ -19,6 +19,8 @@
 ***************************************************************************/
 
 #include "GreeterApp.h"
+#include "BackgroundCache.h"
+#include "BackgroundImageProvider.h"
 #include "Configuration.h"
 #include "GreeterProxy.h"
 #include "Constants.h"
@@ -65,6 +67,9 @@ namespace SDDM {
         // Create models
         m_sessionModel = new SessionModel();
         m_keyboard = new KeyboardModel();
+
+        // Decoded backgrounds, shared by the views of all screens
+        m_backgrounds = new BackgroundCache(BackgroundCache::defaultDirectory());
     }
 
     bool GreeterApp::isTestModeEnabled() const
@@ -123,6 +128,7 @@ namespace SDDM {
 
         if (!m_userModel)
             m_userModel = new UserModel(themeNeedsAllUsers, nullptr);
+        m_sessionModel->setUserModel(m_userModel);
 
         // Set default icon theme from greeter theme
         if (m_themeConfig->contains(QStringLiteral("iconTheme")))
@@ -168,6 +174,7 @@ namespace SDDM {
         });
 
         view->engine()->addImportPath(QStringLiteral(IMPORTS_INSTALL_DIR));
+        view->engine()->addImageProvider(QStringLiteral("sddm-background"), new BackgroundImageProvider(m_backgrounds));
 
         // connect proxy signals
         connect(m_proxy, &GreeterProxy::loginSucceeded, view, &QQuickView::close);
@@ -251,13 +258,19 @@ namespace SDDM {
             return;
         }
 
-        // Set numlock upon start
-        if (m_keyboard->enabled()) {
-            if (mainConfig.Numlock.get() == MainConfig::NUM_SET_ON)
+        // Set numlock upon start, the daemon tells us what it should be
+        auto setNumLock = [this](int state) {
+            if (!m_keyboard->enabled())
+                return;
+            if (state == MainConfig::NUM_SET_ON)
                 m_keyboard->setNumLockState(true);
-            else if (mainConfig.Numlock.get() == MainConfig::NUM_SET_OFF)
+            else if (state == MainConfig::NUM_SET_OFF)
                 m_keyboard->setNumLockState(false);
-        }
+        };
+        if (m_proxy->isConnected())
+            connect(m_proxy, &GreeterProxy::bootstrapped, this, [this, setNumLock] { setNumLock(m_proxy->numLock()); });
+        else
+            setNumLock(mainConfig.Numlock.get());
 
         // Set font
         const QString fontStr = mainConfig.Theme.Font.get();
@@ -271,6 +284,13 @@ namespace SDDM {
         // Set session model on proxy
         m_proxy->setSessionModel(m_sessionModel);
 
+        // Preselect what the daemon remembers, it knows about logins that
+        // didn't make it to state.conf yet
+        connect(m_proxy, &GreeterProxy::bootstrapped, this, [this] {
+            m_userModel->setLastUser(m_proxy->lastUser());
+            m_sessionModel->setLastSession(m_proxy->lastSession());
+        });
+
         // If the socket ends, bail. There is not much we can do.
         connect(m_proxy, &GreeterProxy::socketDisconnected, qGuiApp, &QCoreApplication::quit);
 
@@ -28,6 +28,7 @@
 class QTranslator;
 
 namespace SDDM {
+    class BackgroundCache;
     class Configuration;
     class ThemeMetadata;
     class ThemeConfig;
@@ -76,6 +77,7 @@ namespace SDDM {
         UserModel *m_userModel { nullptr };
         GreeterProxy *m_proxy { nullptr };
         KeyboardModel *m_keyboard { nullptr };
+        BackgroundCache *m_backgrounds { nullptr };
 
         void startup();
         void activatePrimary();
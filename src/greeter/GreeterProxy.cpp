@@ -28,6 +28,24 @@
 #include <QLocalSocket>
 
 namespace SDDM {
+    // the capability a power action request stands for
+    static Capability powerAction(GreeterMessages message) {
+        switch (message) {
+            case GreeterMessages::PowerOff:
+                return PowerOff;
+            case GreeterMessages::Reboot:
+                return Reboot;
+            case GreeterMessages::Suspend:
+                return Suspend;
+            case GreeterMessages::Hibernate:
+                return Hibernate;
+            case GreeterMessages::HybridSleep:
+                return HybridSleep;
+            default:
+                return None;
+        }
+    }
+
     class GreeterProxyPrivate {
     public:
         SessionModel *sessionModel { nullptr };
@@ -38,6 +56,9 @@ namespace SDDM {
         bool canSuspend { false };
         bool canHibernate { false };
         bool canHybridSleep { false };
+        QString lastUser;
+        QString lastSession;
+        int numLock { 0 };
     };
 
     GreeterProxy::GreeterProxy(const QString &socket, QObject *parent) : QObject(parent), d(new GreeterProxyPrivate()) {
@@ -84,6 +105,18 @@ namespace SDDM {
         return d->canHybridSleep;
     }
 
+    const QString &GreeterProxy::lastUser() const {
+        return d->lastUser;
+    }
+
+    const QString &GreeterProxy::lastSession() const {
+        return d->lastSession;
+    }
+
+    int GreeterProxy::numLock() const {
+        return d->numLock;
+    }
+
     bool GreeterProxy::isConnected() const {
         return d->socket->state() == QLocalSocket::ConnectedState;
     }
@@ -146,6 +179,22 @@ namespace SDDM {
         qCritical() << "Socket error: " << d->socket->errorString();
     }
 
+    void GreeterProxy::setCapabilities(quint32 capabilities) {
+        // parse capabilities
+        d->canPowerOff = capabilities & Capability::PowerOff;
+        d->canReboot = capabilities & Capability::Reboot;
+        d->canSuspend = capabilities & Capability::Suspend;
+        d->canHibernate = capabilities & Capability::Hibernate;
+        d->canHybridSleep = capabilities & Capability::HybridSleep;
+
+        // emit signals
+        emit canPowerOffChanged(d->canPowerOff);
+        emit canRebootChanged(d->canReboot);
+        emit canSuspendChanged(d->canSuspend);
+        emit canHibernateChanged(d->canHibernate);
+        emit canHybridSleepChanged(d->canHybridSleep);
+    }
+
     void GreeterProxy::readyRead() {
         // input stream
         QDataStream input(d->socket);
@@ -164,19 +213,22 @@ namespace SDDM {
                     quint32 capabilities;
                     input >> capabilities;
 
-                    // parse capabilities
-                    d->canPowerOff = capabilities & Capability::PowerOff;
-                    d->canReboot = capabilities & Capability::Reboot;
-                    d->canSuspend = capabilities & Capability::Suspend;
-                    d->canHibernate = capabilities & Capability::Hibernate;
-                    d->canHybridSleep = capabilities & Capability::HybridSleep;
+                    setCapabilities(capabilities);
+                }
+                break;
+                case DaemonMessages::Bootstrap: {
+                    // log message
+                    qDebug() << "Message received from daemon: Bootstrap";
+
+                    // read everything at once
+                    quint32 capabilities, numLock;
+                    input >> d->hostName >> capabilities >> d->lastUser >> d->lastSession >> numLock;
+                    d->numLock = numLock;
 
                     // emit signals
-                    emit canPowerOffChanged(d->canPowerOff);
-                    emit canRebootChanged(d->canReboot);
-                    emit canSuspendChanged(d->canSuspend);
-                    emit canHibernateChanged(d->canHibernate);
-                    emit canHybridSleepChanged(d->canHybridSleep);
+                    emit hostNameChanged(d->hostName);
+                    setCapabilities(capabilities);
+                    emit bootstrapped();
                 }
                 break;
                 case DaemonMessages::HostName: {
@@ -214,6 +266,18 @@ namespace SDDM {
                     emit informationMessage(message);
                 }
                 break;
+                case DaemonMessages::PowerActionFinished: {
+                    quint32 action, success;
+                    QString errorMessage;
+                    input >> action >> success >> errorMessage;
+
+                    // log message
+                    qDebug() << "Message received from daemon: PowerActionFinished" << action << success << errorMessage;
+
+                    // emit signal
+                    emit powerActionFinished(powerAction(GreeterMessages(action)), success, errorMessage);
+                }
+                break;
                 default: {
                     // log message
                     qWarning() << "Unknown message received from daemon.";
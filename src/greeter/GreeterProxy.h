@@ -38,6 +38,8 @@ namespace SDDM {
         Q_PROPERTY(bool     canSuspend      READ canSuspend     NOTIFY canSuspendChanged)
         Q_PROPERTY(bool     canHibernate    READ canHibernate   NOTIFY canHibernateChanged)
         Q_PROPERTY(bool     canHybridSleep  READ canHybridSleep NOTIFY canHybridSleepChanged)
+        Q_PROPERTY(QString  lastUser        READ lastUser       NOTIFY bootstrapped)
+        Q_PROPERTY(QString  lastSession     READ lastSession    NOTIFY bootstrapped)
 
     public:
         explicit GreeterProxy(const QString &socket, QObject *parent = 0);
@@ -51,6 +53,10 @@ namespace SDDM {
         bool canHibernate() const;
         bool canHybridSleep() const;
 
+        const QString &lastUser() const;
+        const QString &lastSession() const;
+        int numLock() const;
+
         bool isConnected() const;
 
         void setSessionModel(SessionModel *model);
@@ -72,6 +78,8 @@ namespace SDDM {
 
     signals:
         void informationMessage(const QString &message);
+        // action is the Capability that was requested, e.g. PowerOff
+        void powerActionFinished(int action, bool success, const QString &errorMessage);
         void hostNameChanged(const QString &hostName);
         void canPowerOffChanged(bool canPowerOff);
         void canRebootChanged(bool canReboot);
@@ -79,11 +87,15 @@ namespace SDDM {
         void canHibernateChanged(bool canHibernate);
         void canHybridSleepChanged(bool canHybridSleep);
 
+        void bootstrapped();
+
         void socketDisconnected();
         void loginFailed();
         void loginSucceeded();
 
     private:
+        void setCapabilities(quint32 capabilities);
+
         GreeterProxyPrivate *d { nullptr };
     };
 }
@@ -20,19 +20,19 @@
 #include "KeyboardLayout.h"
 
 namespace SDDM {
-    KeyboardLayout::KeyboardLayout(QString shortName, QString longName)
-        : m_short(shortName)
-        , m_long(longName)
+    KeyboardLayout::KeyboardLayout(const QString &shortName, const QString &longName)
+        : shortName(shortName)
+        , longName(longName)
     {
     }
 
-    QString KeyboardLayout::shortName() const
+    bool KeyboardLayout::operator==(const KeyboardLayout &other) const
     {
-        return m_short;
+        return shortName == other.shortName && longName == other.longName;
     }
 
-    QString KeyboardLayout::longName() const
+    bool KeyboardLayout::operator!=(const KeyboardLayout &other) const
     {
-        return m_long;
+        return !(*this == other);
     }
 }
@@ -20,24 +20,27 @@
 #ifndef KEYBOARDLAYOUT_H
 #define KEYBOARDLAYOUT_H
 
+#include <QtCore/QMetaType>
 #include <QtCore/QObject>
+#include <QtCore/QString>
 
 namespace SDDM {
-    class KeyboardLayout : public QObject {
-        Q_OBJECT
-        Q_PROPERTY(QString shortName READ shortName CONSTANT)
-        Q_PROPERTY(QString longName READ longName CONSTANT)
+    struct KeyboardLayout {
+        Q_GADGET
+        Q_PROPERTY(QString shortName MEMBER shortName CONSTANT)
+        Q_PROPERTY(QString longName MEMBER longName CONSTANT)
     public:
-        KeyboardLayout(QString shortName, QString longName);
+        KeyboardLayout() = default;
+        KeyboardLayout(const QString &shortName, const QString &longName);
 
-        virtual ~KeyboardLayout() = default;
+        bool operator==(const KeyboardLayout &other) const;
+        bool operator!=(const KeyboardLayout &other) const;
 
-        QString shortName() const;
-        QString longName() const;
-
-    private:
-        QString m_short, m_long;
+        QString shortName;
+        QString longName;
     };
 }
 
+Q_DECLARE_METATYPE(SDDM::KeyboardLayout)
+
 #endif // KEYBOARDLAYOUT_H
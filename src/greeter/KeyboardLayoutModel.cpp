@@ -0,0 +1,80 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "KeyboardLayoutModel.h"
+
+namespace SDDM {
+    KeyboardLayoutModel::KeyboardLayoutModel(QObject *parent) : QAbstractListModel(parent) {
+    }
+
+    QHash<int, QByteArray> KeyboardLayoutModel::roleNames() const {
+        // set role names
+        QHash<int, QByteArray> roleNames;
+        roleNames[ShortNameRole] = QByteArrayLiteral("shortName");
+        roleNames[LongNameRole] = QByteArrayLiteral("longName");
+        roleNames[ModelDataRole] = QByteArrayLiteral("modelData");
+
+        return roleNames;
+    }
+
+    int KeyboardLayoutModel::rowCount(const QModelIndex &parent) const {
+        return parent.isValid() ? 0 : m_layouts.size();
+    }
+
+    QVariant KeyboardLayoutModel::data(const QModelIndex &index, int role) const {
+        if (index.row() < 0 || index.row() >= m_layouts.size())
+            return QVariant();
+
+        const KeyboardLayout &layout = m_layouts.at(index.row());
+
+        // return correct value
+        switch (role) {
+        case Qt::DisplayRole:
+        case LongNameRole:
+            return layout.longName;
+        case ShortNameRole:
+            return layout.shortName;
+        case ModelDataRole:
+            return QVariant::fromValue(layout);
+        default:
+            break;
+        }
+
+        // return empty value
+        return QVariant();
+    }
+
+    const QVector<KeyboardLayout> &KeyboardLayoutModel::layouts() const {
+        return m_layouts;
+    }
+
+    void KeyboardLayoutModel::setLayouts(const QVector<KeyboardLayout> &layouts) {
+        if (layouts == m_layouts)
+            return;
+
+        const bool countChanged = layouts.size() != m_layouts.size();
+
+        beginResetModel();
+        m_layouts = layouts;
+        endResetModel();
+
+        if (countChanged)
+            emit this->countChanged();
+    }
+}
@@ -0,0 +1,61 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_KEYBOARDLAYOUTMODEL_H
+#define SDDM_KEYBOARDLAYOUTMODEL_H
+
+#include "KeyboardLayout.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+namespace SDDM {
+    class KeyboardLayoutModel : public QAbstractListModel {
+        Q_OBJECT
+        Q_DISABLE_COPY(KeyboardLayoutModel)
+        Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    public:
+        enum KeyboardLayoutRole {
+            ShortNameRole = Qt::UserRole + 1,
+            LongNameRole,
+            // the whole layout, like the entries of KeyboardModel::layouts
+            ModelDataRole
+        };
+        Q_ENUM(KeyboardLayoutRole)
+
+        explicit KeyboardLayoutModel(QObject *parent = nullptr);
+
+        QHash<int, QByteArray> roleNames() const override;
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+        const QVector<KeyboardLayout> &layouts() const;
+        void setLayouts(const QVector<KeyboardLayout> &layouts);
+
+    signals:
+        void countChanged();
+
+    private:
+        QVector<KeyboardLayout> m_layouts;
+    };
+}
+
+#endif // SDDM_KEYBOARDLAYOUTMODEL_H
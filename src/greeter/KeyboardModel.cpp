@@ -20,6 +20,7 @@
 
 #include <QGuiApplication>
 
+#include "KeyboardLayoutModel.h"
 #include "KeyboardModel.h"
 #include "KeyboardModel_p.h"
 #include "waylandkeyboardbackend.h"
@@ -30,7 +31,7 @@ namespace SDDM {
     /* KeyboardModel                              */
     /**********************************************/
 
-    KeyboardModel::KeyboardModel() : d(new KeyboardModelPrivate) {
+    KeyboardModel::KeyboardModel() : d(new KeyboardModelPrivate), m_layouts(new KeyboardLayoutModel(this)) {
         if (QGuiApplication::platformName() == QLatin1String("xcb")) {
             m_backend = new XcbKeyboardBackend(d);
             m_backend->init();
@@ -38,7 +39,10 @@ namespace SDDM {
         } else if (QGuiApplication::platformName().contains(QLatin1String("wayland"))) {
             m_backend = new WaylandKeyboardBackend(d);
             m_backend->init();
+            m_backend->connectEventsDispatcher(this);
         }
+
+        m_layouts->setLayouts(d->layouts);
     }
 
     KeyboardModel::~KeyboardModel() {
@@ -46,10 +50,6 @@ namespace SDDM {
             m_backend->disconnect();
             delete m_backend;
         }
-
-        for (QObject *layout: d->layouts) {
-            delete layout;
-        }
         delete d;
     }
 
@@ -81,8 +81,15 @@ namespace SDDM {
         }
     }
 
-    QList<QObject*> KeyboardModel::layouts() const {
-        return d->layouts;
+    QVariantList KeyboardModel::layouts() const {
+        QVariantList layouts;
+        for (const KeyboardLayout &layout : m_layouts->layouts())
+            layouts << QVariant::fromValue(layout);
+        return layouts;
+    }
+
+    QAbstractListModel *KeyboardModel::layoutModel() const {
+        return m_layouts;
     }
 
     int KeyboardModel::currentLayout() const {
@@ -107,7 +114,6 @@ namespace SDDM {
         // Save old states
         bool num_old = d->numlock.enabled, caps_old = d->capslock.enabled;
         int layout_old = d->layout_id;
-        QList<QObject*> layouts_old = d->layouts;
 
         // Process events
         if (m_backend)
@@ -123,8 +129,10 @@ namespace SDDM {
         if (layout_old != d->layout_id)
             emit currentLayoutChanged();
 
-        if (layouts_old != d->layouts)
+        if (m_layouts->layouts() != d->layouts) {
+            m_layouts->setLayouts(d->layouts);
             emit layoutsChanged();
+        }
     }
 }
 
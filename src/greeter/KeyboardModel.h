@@ -20,13 +20,15 @@
 #ifndef KEYBOARDMODEL_H
 #define KEYBOARDMODEL_H
 
-#include <QList>
+#include <QAbstractListModel>
 #include <QObject>
 #include <QString>
+#include <QVariantList>
 
 namespace SDDM {
     class KeyboardModelPrivate;
     class KeyboardBackend;
+    class KeyboardLayoutModel;
 
     class KeyboardModel : public QObject {
         Q_OBJECT
@@ -38,7 +40,9 @@ namespace SDDM {
 
         // Layouts control
         Q_PROPERTY(int currentLayout READ currentLayout WRITE setCurrentLayout NOTIFY currentLayoutChanged)
-        Q_PROPERTY(QList<QObject*> layouts READ layouts NOTIFY layoutsChanged)
+        Q_PROPERTY(QVariantList layouts READ layouts NOTIFY layoutsChanged)
+        // the same layouts as a model, so views only create the delegates they show
+        Q_PROPERTY(QAbstractListModel *layoutModel READ layoutModel CONSTANT)
 
         Q_PROPERTY(bool enabled READ enabled CONSTANT)
 
@@ -60,7 +64,8 @@ namespace SDDM {
         bool capsLockState() const;
         void setCapsLockState(bool state);
 
-        QList<QObject*> layouts() const;
+        QVariantList layouts() const;
+        QAbstractListModel *layoutModel() const;
         int currentLayout() const;
         void setCurrentLayout(int id);
 
@@ -72,6 +77,7 @@ namespace SDDM {
     private:
         KeyboardModelPrivate * d { nullptr };
         KeyboardBackend * m_backend = nullptr;
+        KeyboardLayoutModel * m_layouts { nullptr };
     };
 }
 
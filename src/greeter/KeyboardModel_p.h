@@ -21,6 +21,9 @@
 #define KEYBOARDMODEL_P_H
 
 #include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include "KeyboardLayout.h"
 
 namespace SDDM {
     struct Indicator {
@@ -38,7 +41,7 @@ namespace SDDM {
 
         // Layouts
         int layout_id { 0 };
-        QList<QObject*> layouts;
+        QVector<KeyboardLayout> layouts;
     };
 }
 
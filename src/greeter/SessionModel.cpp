@@ -21,6 +21,8 @@
 #include "SessionModel.h"
 
 #include "Configuration.h"
+#include "LastSessions.h"
+#include "UserModel.h"
 
 #include <QFileInfo>
 #include <QVector>
@@ -36,11 +38,17 @@ namespace SDDM {
         }
 
         int lastIndex { 0 };
+        QString user;
+        QString lastSession;
+        UserModel *userModel { nullptr };
+        LastSessions lastSessions;
         QStringList displayNames;
         QVector<Session *> sessions;
     };
 
     SessionModel::SessionModel(QObject *parent) : QAbstractListModel(parent), d(new SessionModelPrivate()) {
+        d->lastSession = stateConfig.Last.Session.get();
+
         // Check for flag to show Wayland sessions
         bool dri_active = QFileInfo::exists(QStringLiteral("/dev/dri"));
 
@@ -50,6 +58,7 @@ namespace SDDM {
             populate(Session::WaylandSession, mainConfig.Wayland.SessionDir.get());
         populate(Session::X11Session, mainConfig.X11.SessionDir.get());
         endResetModel();
+        updateLastIndex();
 
         // refresh everytime a file is changed, added or removed
         QFileSystemWatcher *watcher = new QFileSystemWatcher(this);
@@ -63,6 +72,7 @@ namespace SDDM {
                 populate(Session::WaylandSession, mainConfig.Wayland.SessionDir.get());
             populate(Session::X11Session, mainConfig.X11.SessionDir.get());
             endResetModel();
+            updateLastIndex();
         });
         watcher->addPaths(mainConfig.Wayland.SessionDir.get());
         watcher->addPaths(mainConfig.X11.SessionDir.get());
@@ -89,6 +99,57 @@ namespace SDDM {
         return d->lastIndex;
     }
 
+    QString SessionModel::user() const {
+        return d->user;
+    }
+
+    void SessionModel::setUser(const QString &user) {
+        if (d->user == user)
+            return;
+        d->user = user;
+        emit userChanged();
+        updateLastIndex();
+    }
+
+    void SessionModel::setUserModel(UserModel *userModel) {
+        if (d->userModel == userModel)
+            return;
+        d->userModel = userModel;
+        updateLastIndex();
+    }
+
+    void SessionModel::setLastSession(const QString &session) {
+        if (d->lastSession == session)
+            return;
+        d->lastSession = session;
+        updateLastIndex();
+    }
+
+    void SessionModel::updateLastIndex() {
+        QString lastSession;
+
+        // the session this user picked last time, falling back to the last one of anybody;
+        // the user model already knows the uids, don't ask NSS on every selection
+        const int uid = d->userModel && !d->user.isEmpty() ? d->userModel->uid(d->user) : -1;
+        if (uid >= 0)
+            lastSession = d->lastSessions.session(uid_t(uid));
+        if (lastSession.isEmpty())
+            lastSession = d->lastSession;
+
+        int lastIndex = 0;
+        for (int i = 0; i < d->sessions.size(); ++i) {
+            if (d->sessions.at(i)->fileName() == lastSession) {
+                lastIndex = i;
+                break;
+            }
+        }
+
+        if (lastIndex != d->lastIndex) {
+            d->lastIndex = lastIndex;
+            emit lastIndexChanged();
+        }
+    }
+
     int SessionModel::rowCount(const QModelIndex &parent) const {
         return parent.isValid() ? 0 : d->sessions.length();
     }
@@ -164,12 +225,5 @@ namespace SDDM {
                 delete si;
             }
         }
-        // find out index of the last session
-        for (int i = 0; i < d->sessions.size(); ++i) {
-            if (d->sessions.at(i)->fileName() == stateConfig.Last.Session.get()) {
-                d->lastIndex = i;
-                break;
-            }
-        }
     }
 }
@@ -29,11 +29,13 @@
 
 namespace SDDM {
     class SessionModelPrivate;
+    class UserModel;
 
     class SessionModel : public QAbstractListModel {
         Q_OBJECT
         Q_DISABLE_COPY(SessionModel)
-        Q_PROPERTY(int lastIndex READ lastIndex CONSTANT)
+        Q_PROPERTY(int lastIndex READ lastIndex NOTIFY lastIndexChanged)
+        Q_PROPERTY(QString user READ user WRITE setUser NOTIFY userChanged)
         Q_PROPERTY(int count READ rowCount CONSTANT)
     public:
         enum SessionRole {
@@ -53,13 +55,27 @@ namespace SDDM {
 
         int lastIndex() const;
 
+        QString user() const;
+        void setUser(const QString &user);
+
+        // where the uids of the users come from
+        void setUserModel(UserModel *userModel);
+
+        // the last session of anybody, from the daemon
+        void setLastSession(const QString &session);
+
         int rowCount(const QModelIndex &parent = QModelIndex()) const override;
         QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+    signals:
+        void lastIndexChanged();
+        void userChanged();
+
     private:
         SessionModelPrivate *d { nullptr };
 
         void populate(Session::Type type, const QStringList &dirPaths);
+        void updateLastIndex();
     };
 }
 
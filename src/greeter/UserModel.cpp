@@ -59,11 +59,14 @@ namespace SDDM {
     class UserModelPrivate {
     public:
         int lastIndex { 0 };
+        QString lastUser;
         QList<UserPtr> users;
         bool containsAllUsers { true };
     };
 
     UserModel::UserModel(bool needAllUsers, QObject *parent) : QAbstractListModel(parent), d(new UserModelPrivate()) {
+        d->lastUser = stateConfig.Last.User.get();
+
         const QString facesDir = mainConfig.Theme.FacesDir.get();
         const QString themeDir = mainConfig.Theme.ThemeDir.get();
         const QString currentTheme = mainConfig.Theme.Current.get();
@@ -130,7 +133,7 @@ namespace SDDM {
         // find out index of the last user
         for (int i = 0; i < d->users.size(); ++i) {
             UserPtr user { d->users.at(i) };
-            if (user->name == stateConfig.Last.User.get())
+            if (user->name == d->lastUser)
                 d->lastIndex = i;
 
             if (avatarsEnabled) {
@@ -175,7 +178,35 @@ namespace SDDM {
     }
 
     QString UserModel::lastUser() const {
-        return stateConfig.Last.User.get();
+        return d->lastUser;
+    }
+
+    void UserModel::setLastUser(const QString &user) {
+        if (d->lastUser == user)
+            return;
+        d->lastUser = user;
+        emit lastUserChanged();
+
+        int lastIndex = 0;
+        for (int i = 0; i < d->users.size(); ++i) {
+            if (d->users.at(i)->name == user) {
+                lastIndex = i;
+                break;
+            }
+        }
+
+        if (lastIndex != d->lastIndex) {
+            d->lastIndex = lastIndex;
+            emit lastIndexChanged();
+        }
+    }
+
+    int UserModel::uid(const QString &name) const {
+        for (const UserPtr &user : qAsConst(d->users)) {
+            if (user->name == name)
+                return user->uid;
+        }
+        return -1;
     }
 
     int UserModel::rowCount(const QModelIndex &parent) const {
@@ -30,8 +30,8 @@ namespace SDDM {
     class UserModel : public QAbstractListModel {
         Q_OBJECT
         Q_DISABLE_COPY(UserModel)
-        Q_PROPERTY(int lastIndex READ lastIndex CONSTANT)
-        Q_PROPERTY(QString lastUser READ lastUser CONSTANT)
+        Q_PROPERTY(int lastIndex READ lastIndex NOTIFY lastIndexChanged)
+        Q_PROPERTY(QString lastUser READ lastUser NOTIFY lastUserChanged)
         Q_PROPERTY(int count READ rowCount CONSTANT)
         Q_PROPERTY(int disableAvatarsThreshold READ disableAvatarsThreshold CONSTANT)
         Q_PROPERTY(bool containsAllUsers READ containsAllUsers CONSTANT)
@@ -52,12 +52,22 @@ namespace SDDM {
 
         int lastIndex() const;
         QString lastUser() const;
+        // the daemon's word on it, state.conf might not be written yet
+        void setLastUser(const QString &user);
+
+        // -1 for users that aren't in the model
+        int uid(const QString &name) const;
 
         int rowCount(const QModelIndex &parent = QModelIndex()) const override;
         QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
         int disableAvatarsThreshold() const;
         bool containsAllUsers() const;
+
+    signals:
+        void lastIndexChanged();
+        void lastUserChanged();
+
     private:
         UserModelPrivate *d { nullptr };
     };
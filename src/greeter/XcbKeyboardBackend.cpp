@@ -17,9 +17,15 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 ***************************************************************************/
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QObject>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QtAlgorithms>
+#include <QtGui/QGuiApplication>
+#if QT_VERSION < QT_VERSION_CHECK(6, 2, 0)
+#include <qpa/qplatformnativeinterface.h>
+#endif
 
 #include "KeyboardModel.h"
 #include "KeyboardModel_p.h"
@@ -29,6 +35,21 @@
 #include <QSocketNotifier>
 
 namespace SDDM {
+    static xcb_connection_t *qtConnection() {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+#if QT_CONFIG(xcb)
+        if (auto *x11 = qGuiApp->nativeInterface<QNativeInterface::QX11Application>())
+            return x11->connection();
+#endif
+        return nullptr;
+#else
+        QPlatformNativeInterface *native = QGuiApplication::platformNativeInterface();
+        if (!native)
+            return nullptr;
+        return static_cast<xcb_connection_t *>(native->nativeResourceForIntegration(QByteArrayLiteral("connection")));
+#endif
+    }
+
     XcbKeyboardBackend::XcbKeyboardBackend(KeyboardModelPrivate *kmp) : KeyboardBackend(kmp) {
     }
 
@@ -37,17 +58,113 @@ namespace SDDM {
 
     void XcbKeyboardBackend::init() {
         connectToDisplay();
-        if (d->enabled)
-            initLedMap();
-        if (d->enabled)
-            initLayouts();
-        if (d->enabled)
-            initState();
+        if (!d->enabled)
+            return;
+
+        // Send all requests up front, so that their replies arrive together
+        // instead of taking a round trip each
+        xcb_xkb_use_extension_cookie_t extensionCookie =
+                xcb_xkb_use_extension(m_conn, XCB_XKB_MAJOR_VERSION, XCB_XKB_MINOR_VERSION);
+        xcb_xkb_get_names_cookie_t namesCookie = xcb_xkb_get_names(m_conn,
+                XCB_XKB_ID_USE_CORE_KBD,
+                XCB_XKB_NAME_DETAIL_INDICATOR_NAMES | XCB_XKB_NAME_DETAIL_GROUP_NAMES | XCB_XKB_NAME_DETAIL_SYMBOLS);
+        xcb_xkb_get_indicator_map_cookie_t indicatorsCookie =
+                xcb_xkb_get_indicator_map(m_conn, XCB_XKB_ID_USE_CORE_KBD, 0xffffffff);
+        xcb_xkb_get_state_cookie_t stateCookie = xcb_xkb_get_state(m_conn, XCB_XKB_ID_USE_CORE_KBD);
+
+        xcb_generic_error_t *error = nullptr;
+        free(xcb_xkb_use_extension_reply(m_conn, extensionCookie, &error));
+        if (error) {
+            qCritical() << "xcb_xkb_use_extension failed, extension disabled, error code"
+                        << error->error_code;
+            free(error);
+            xcb_discard_reply(m_conn, namesCookie.sequence);
+            xcb_discard_reply(m_conn, indicatorsCookie.sequence);
+            xcb_discard_reply(m_conn, stateCookie.sequence);
+            d->enabled = false;
+            return;
+        }
+
+        xcb_xkb_get_names_reply_t *names = xcb_xkb_get_names_reply(m_conn, namesCookie, &error);
+        if (!names) {
+            qCritical() << "Can't get keyboard names: " << (error ? error->error_code : 0);
+            free(error);
+            xcb_discard_reply(m_conn, indicatorsCookie.sequence);
+            xcb_discard_reply(m_conn, stateCookie.sequence);
+            d->enabled = false;
+            return;
+        }
+
+        // Unpack
+        xcb_xkb_get_names_value_list_t list;
+        const void *buffer = xcb_xkb_get_names_value_list(names);
+        xcb_xkb_get_names_value_list_unpack(buffer, names->nTypes, names->indicators,
+                names->virtualMods, names->groupNames, names->nKeys, names->nKeyAliases,
+                names->nRadioGroups, names->which, &list);
+
+        // Ask for all the atom names before waiting for anything else
+        const uint32_t indicators = names->indicators;
+        const QVector<xcb_get_atom_name_cookie_t> indicatorCookies = requestAtomNames(list.indicatorNames,
+                xcb_xkb_get_names_value_list_indicator_names_length(names, &list));
+        const xcb_get_atom_name_cookie_t symbolsCookie = xcb_get_atom_name(m_conn, list.symbolsName);
+        const QVector<xcb_get_atom_name_cookie_t> groupCookies = requestAtomNames(list.groups,
+                xcb_xkb_get_names_value_list_groups_length(names, &list));
+        free(names);
+
+        // Led masks, the names are in the order of the indicators they belong to
+        xcb_xkb_get_indicator_map_reply_t *map = xcb_xkb_get_indicator_map_reply(m_conn, indicatorsCookie, &error);
+        if (!map) {
+            qWarning() << "Can't get indicator masks " << (error ? error->error_code : 0);
+            free(error);
+        }
+
+        int n = 0;
+        for (int i = 0; i < 32 && n < indicatorCookies.size(); i++) {
+            if (!(indicators & (1u << i)))
+                continue;
+
+            QString name = atomName(indicatorCookies[n++]);
+
+            if (name == QLatin1String("Num Lock")) {
+                d->numlock.mask = indicatorMask(map, i);
+            } else if (name == QLatin1String("Caps Lock")) {
+                d->capslock.mask = indicatorMask(map, i);
+            }
+        }
+        for (; n < indicatorCookies.size(); n++)
+            xcb_discard_reply(m_conn, indicatorCookies[n].sequence);
+        free(map);
+
+        // Layouts
+        setLayouts(atomName(symbolsCookie), groupCookies);
+
+        // Get xkb state
+        xcb_xkb_get_state_reply_t *state = xcb_xkb_get_state_reply(m_conn, stateCookie, &error);
+        if (state) {
+            // Set locks state
+            d->capslock.enabled = state->lockedMods & d->capslock.mask;
+            d->numlock.enabled  = state->lockedMods & d->numlock.mask;
+
+            // Set current layout
+            d->layout_id = state->group;
+
+            // Free
+            free(state);
+        } else {
+            // Log error and disable extension
+            qCritical() << "Can't load leds state - " << (error ? error->error_code : 0);
+            free(error);
+            d->enabled = false;
+        }
     }
 
     void XcbKeyboardBackend::disconnect() {
-        delete m_socket;
-        xcb_disconnect(m_conn);
+        if (m_ownConnection) {
+            delete m_socket;
+            xcb_disconnect(m_conn);
+        } else if (m_model) {
+            QCoreApplication::instance()->removeNativeEventFilter(this);
+        }
     }
 
     void XcbKeyboardBackend::sendChanges() {
@@ -71,78 +188,31 @@ namespace SDDM {
 
         if (error) {
             qWarning() << "Can't update state: " << error->error_code;
+            free(error);
         }
     }
 
     void XcbKeyboardBackend::connectToDisplay() {
-        // Connect and initialize xkb extension
-        xcb_xkb_use_extension_cookie_t cookie;
-        xcb_generic_error_t *error = nullptr;
-
-        m_conn = xcb_connect(nullptr, nullptr);
-        if (m_conn == nullptr) {
-            qCritical() << "xcb_connect failed, keyboard extension disabled";
-            d->enabled = false;
-            return;
+        // Share Qt's connection, a second one costs another handshake
+        m_conn = qtConnection();
+        if (!m_conn) {
+            m_ownConnection = true;
+            m_conn = xcb_connect(nullptr, nullptr);
+            if (xcb_connection_has_error(m_conn)) {
+                qCritical() << "xcb_connect failed, keyboard extension disabled";
+                d->enabled = false;
+                return;
+            }
         }
 
-        // Initialize xkb extension
-        cookie = xcb_xkb_use_extension(m_conn, XCB_XKB_MAJOR_VERSION, XCB_XKB_MINOR_VERSION);
-        xcb_xkb_use_extension_reply(m_conn, cookie, &error);
-
-        if (error != nullptr) {
-            qCritical() << "xcb_xkb_use_extension failed, extension disabled, error code"
-                        << error->error_code;
+        // Cached by xcb, Qt has looked it up already
+        const xcb_query_extension_reply_t *extension = xcb_get_extension_data(m_conn, &xcb_xkb_id);
+        if (!extension || !extension->present) {
+            qCritical() << "XKB not available, keyboard extension disabled";
             d->enabled = false;
             return;
         }
-    }
-
-    void XcbKeyboardBackend::initLedMap() {
-        // Get indicator names atoms
-        xcb_xkb_get_names_cookie_t cookie;
-        xcb_xkb_get_names_reply_t *reply = nullptr;
-        xcb_generic_error_t *error = nullptr;
-
-        cookie = xcb_xkb_get_names(m_conn,
-                XCB_XKB_ID_USE_CORE_KBD,
-                XCB_XKB_NAME_DETAIL_INDICATOR_NAMES);
-        reply = xcb_xkb_get_names_reply(m_conn, cookie, &error);
-
-        if (error) {
-            qCritical() << "Can't init led map: " << error->error_code;
-            d->enabled = false;
-            return;
-        }
-
-        // Unpack
-        xcb_xkb_get_names_value_list_t list;
-        const void *buffer = xcb_xkb_get_names_value_list(reply);
-        xcb_xkb_get_names_value_list_unpack(buffer, reply->nTypes, reply->indicators,
-                reply->virtualMods, reply->groupNames, reply->nKeys, reply->nKeyAliases,
-                reply->nRadioGroups, reply->which, &list);
-
-        // Get indicators count
-        int ind_cnt = xcb_xkb_get_names_value_list_indicator_names_length(reply, &list);
-
-        // Loop through indicators and get their properties
-        QList<xcb_get_atom_name_cookie_t> cookies;
-        for (int i = 0; i < ind_cnt; i++) {
-            cookies << xcb_get_atom_name(m_conn, list.indicatorNames[i]);
-        }
-
-        for (int i = 0; i < ind_cnt; i++) {
-            QString name = atomName(cookies[i]);
-
-            if (name == QLatin1String("Num Lock")) {
-                d->numlock.mask = getIndicatorMask(i);
-            } else if (name == QLatin1String("Caps Lock")) {
-                d->capslock.mask = getIndicatorMask(i);
-            }
-        }
-
-        // Free memory
-        free(reply);
+        m_xkbEvent = extension->first_event;
     }
 
     void XcbKeyboardBackend::initLayouts() {
@@ -154,11 +224,12 @@ namespace SDDM {
         cookie = xcb_xkb_get_names(m_conn,
                 XCB_XKB_ID_USE_CORE_KBD,
                 XCB_XKB_NAME_DETAIL_GROUP_NAMES | XCB_XKB_NAME_DETAIL_SYMBOLS);
-        reply = xcb_xkb_get_names_reply(m_conn, cookie, nullptr);
+        reply = xcb_xkb_get_names_reply(m_conn, cookie, &error);
 
-        if (error) {
+        if (!reply) {
             // Log and disable
-            qCritical() << "Can't init layouts: " << error->error_code;
+            qCritical() << "Can't init layouts: " << (error ? error->error_code : 0);
+            free(error);
             return;
         }
 
@@ -169,54 +240,38 @@ namespace SDDM {
                 reply->virtualMods, reply->groupNames, reply->nKeys, reply->nKeyAliases,
                 reply->nRadioGroups, reply->which, &res_list);
 
+        // Resolve all names at once
+        const xcb_get_atom_name_cookie_t symbolsCookie = xcb_get_atom_name(m_conn, res_list.symbolsName);
+        const QVector<xcb_get_atom_name_cookie_t> groupCookies = requestAtomNames(res_list.groups,
+                xcb_xkb_get_names_value_list_groups_length(reply, &res_list));
+
+        // Free
+        free(reply);
+
+        setLayouts(atomName(symbolsCookie), groupCookies);
+    }
+
+    void XcbKeyboardBackend::setLayouts(const QString &symbols, const QVector<xcb_get_atom_name_cookie_t> &groups) {
         // Get short names
-        QList<QString> short_names = parseShortNames(atomName(res_list.symbolsName));
+        QList<QString> short_names = parseShortNames(symbols);
 
         // Loop through group names
         d->layouts.clear();
-        int groups_cnt = xcb_xkb_get_names_value_list_groups_length(reply, &res_list);
-
-        QList<xcb_get_atom_name_cookie_t> cookies;
-        for (int i = 0; i < groups_cnt; i++) {
-            cookies << xcb_get_atom_name(m_conn, res_list.groups[i]);
-        }
-
-        for (int i = 0; i < groups_cnt; i++) {
-            QString nshort, nlong = atomName(cookies[i]);
+        for (int i = 0; i < groups.size(); i++) {
+            QString nshort, nlong = atomName(groups[i]);
             if (i < short_names.length())
                 nshort = short_names[i];
 
-            d->layouts << new KeyboardLayout(nshort, nlong);
+            d->layouts << KeyboardLayout(nshort, nlong);
         }
-
-        // Free
-        free(reply);
     }
 
-    void XcbKeyboardBackend::initState() {
-        xcb_xkb_get_state_cookie_t cookie;
-        xcb_xkb_get_state_reply_t *reply = nullptr;
-        xcb_generic_error_t *error = nullptr;
-
-        // Get xkb state
-        cookie = xcb_xkb_get_state(m_conn, XCB_XKB_ID_USE_CORE_KBD);
-        reply = xcb_xkb_get_state_reply(m_conn, cookie, &error);
-
-        if (reply) {
-            // Set locks state
-            d->capslock.enabled = reply->lockedMods & d->capslock.mask;
-            d->numlock.enabled  = reply->lockedMods & d->numlock.mask;
-
-            // Set current layout
-            d->layout_id = reply->group;
-
-            // Free
-            free(reply);
-        } else {
-            // Log error and disable extension
-            qCritical() << "Can't load leds state - " << error->error_code;
-            d->enabled = false;
-        }
+    QVector<xcb_get_atom_name_cookie_t> XcbKeyboardBackend::requestAtomNames(const xcb_atom_t *atoms, int count) const {
+        QVector<xcb_get_atom_name_cookie_t> cookies;
+        cookies.reserve(count);
+        for (int i = 0; i < count; i++)
+            cookies << xcb_get_atom_name(m_conn, atoms[i]);
+        return cookies;
     }
 
     QString XcbKeyboardBackend::atomName(xcb_get_atom_name_cookie_t cookie) const {
@@ -235,36 +290,22 @@ namespace SDDM {
             free(reply);
         } else {
             // Log error
-            qWarning() << "Failed to get atom name: " << error->error_code;
+            qWarning() << "Failed to get atom name: " << (error ? error->error_code : 0);
+            free(error);
         }
         return res;
     }
 
-    QString XcbKeyboardBackend::atomName(xcb_atom_t atom) const {
-        return atomName(xcb_get_atom_name(m_conn, atom));
-    }
-
-    uint8_t XcbKeyboardBackend::getIndicatorMask(uint8_t i) const {
-        xcb_xkb_get_indicator_map_cookie_t cookie;
-        xcb_xkb_get_indicator_map_reply_t *reply = nullptr;
-        xcb_generic_error_t *error = nullptr;
-        uint8_t mask = 0;
-
-        cookie = xcb_xkb_get_indicator_map(m_conn, XCB_XKB_ID_USE_CORE_KBD, 1 << i);
-        reply = xcb_xkb_get_indicator_map_reply(m_conn, cookie, &error);
-
-
-        if (reply) {
-            xcb_xkb_indicator_map_t *map = xcb_xkb_get_indicator_map_maps(reply);
+    uint8_t XcbKeyboardBackend::indicatorMask(const xcb_xkb_get_indicator_map_reply_t *reply, int indicator) {
+        if (!reply || !(reply->which & (1u << indicator)))
+            return 0;
 
-            mask = map->mods;
+        // The maps are only there for the indicators in which
+        const int index = qPopulationCount(reply->which & ((1u << indicator) - 1));
+        if (index >= xcb_xkb_get_indicator_map_maps_length(reply))
+            return 0;
 
-            free(reply);
-        } else {
-            // Log error
-            qWarning() << "Can't get indicator mask " << error->error_code;
-        }
-        return mask;
+        return xcb_xkb_get_indicator_map_maps(reply)[index].mods;
     }
 
     QList<QString> XcbKeyboardBackend::parseShortNames(QString text) {
@@ -286,26 +327,68 @@ namespace SDDM {
     }
 
     void XcbKeyboardBackend::dispatchEvents() {
+        // Events Qt passed on to us
+        const QVector<xcb_generic_event_t> pending = m_pending;
+        m_pending.clear();
+        for (const xcb_generic_event_t &event : pending)
+            handleEvent(&event);
+
+        if (!m_ownConnection)
+            return;
+
         // Pool events
         while (xcb_generic_event_t *event = xcb_poll_for_event(m_conn)) {
-            // Check event types
-            if (event->response_type != 0 && event->pad0 == XCB_XKB_STATE_NOTIFY) {
-                xcb_xkb_state_notify_event_t *e = (xcb_xkb_state_notify_event_t *)event;
-
-                // Update state
-                d->capslock.enabled = e->lockedMods & d->capslock.mask;
-                d->numlock.enabled  = e->lockedMods & d->numlock.mask;
-
-                d->layout_id = e->group;
-            } else if (event->response_type != 0 && event->pad0 == XCB_XKB_NEW_KEYBOARD_NOTIFY) {
-                // Keyboards changed, reinit layouts
-                initLayouts();
-            }
+            handleEvent(event);
             free(event);
         }
     }
 
+    void XcbKeyboardBackend::handleEvent(const xcb_generic_event_t *event) {
+        // Check event types, XKB has a single event code and puts its own type in the next byte
+        if ((event->response_type & ~0x80) != m_xkbEvent)
+            return;
+
+        if (event->pad0 == XCB_XKB_STATE_NOTIFY) {
+            const xcb_xkb_state_notify_event_t *e = reinterpret_cast<const xcb_xkb_state_notify_event_t *>(event);
+
+            // Update state
+            d->capslock.enabled = e->lockedMods & d->capslock.mask;
+            d->numlock.enabled  = e->lockedMods & d->numlock.mask;
+
+            d->layout_id = e->group;
+        } else if (event->pad0 == XCB_XKB_NEW_KEYBOARD_NOTIFY) {
+            // Keyboards changed, reinit layouts
+            initLayouts();
+        }
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    bool XcbKeyboardBackend::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) {
+#else
+    bool XcbKeyboardBackend::nativeEventFilter(const QByteArray &eventType, void *message, long *result) {
+#endif
+        Q_UNUSED(result);
+
+        if (eventType != "xcb_generic_event_t")
+            return false;
+
+        const xcb_generic_event_t *event = static_cast<xcb_generic_event_t *>(message);
+        if ((event->response_type & ~0x80) == m_xkbEvent) {
+            // XKB events have the size of core events, handle them once
+            // Qt is done with the batch
+            if (m_pending.isEmpty())
+                QMetaObject::invokeMethod(m_model, "dispatchEvents", Qt::QueuedConnection);
+            m_pending << *event;
+        }
+
+        // Qt needs to see them as well
+        return false;
+    }
+
     void XcbKeyboardBackend::connectEventsDispatcher(KeyboardModel *model) {
+        if (!d->enabled)
+            return;
+
         // Setup events filter
         xcb_void_cookie_t cookie;
         xcb_xkb_select_events_details_t foo = {};
@@ -318,10 +401,18 @@ namespace SDDM {
         error = xcb_request_check(m_conn, cookie);
         if (error) {
             qCritical() << "Can't select xck-xkb events: " << error->error_code;
+            free(error);
             d->enabled = false;
             return;
         }
 
+        if (!m_ownConnection) {
+            // Qt reads its connection, it hands us the events through the filter
+            m_model = model;
+            QCoreApplication::instance()->installNativeEventFilter(this);
+            return;
+        }
+
         // Flush connection
         xcb_flush(m_conn);
 
@@ -20,7 +20,9 @@
 #ifndef XCBKEYBOARDBACKEND_H
 #define XCBKEYBOARDBACKEND_H
 
+#include <QtCore/QAbstractNativeEventFilter>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 #include "KeyboardBackend.h"
 
@@ -31,7 +33,7 @@
 class QSocketNotifier;
 
 namespace SDDM {
-    class XcbKeyboardBackend : public KeyboardBackend {
+    class XcbKeyboardBackend : public KeyboardBackend, public QAbstractNativeEventFilter {
     public:
         XcbKeyboardBackend(KeyboardModelPrivate *kmp);
         virtual ~XcbKeyboardBackend();
@@ -43,26 +45,38 @@ namespace SDDM {
 
         void connectEventsDispatcher(KeyboardModel *model) override;
 
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override;
+#else
+        bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
+#endif
+
         static QList<QString> parseShortNames(QString text);
 
     private:
         // Initializers
         void connectToDisplay();
-        void initLedMap();
         void initLayouts();
-        void initState();
 
         // Helpers
-        QString atomName(xcb_atom_t atom) const;
+        QVector<xcb_get_atom_name_cookie_t> requestAtomNames(const xcb_atom_t *atoms, int count) const;
         QString atomName(xcb_get_atom_name_cookie_t cookie) const;
+        void setLayouts(const QString &symbols, const QVector<xcb_get_atom_name_cookie_t> &groups);
+        void handleEvent(const xcb_generic_event_t *event);
 
-        uint8_t getIndicatorMask(uint8_t id) const;
+        static uint8_t indicatorMask(const xcb_xkb_get_indicator_map_reply_t *reply, int indicator);
 
-        // Connection
+        // Connection, Qt's unless we had to open our own
         xcb_connection_t *m_conn { nullptr };
+        bool m_ownConnection { false };
+        uint8_t m_xkbEvent { 0 };
 
-        // Socket listener
+        // Socket listener for our own connection
         QSocketNotifier *m_socket { nullptr };
+
+        // XKB events seen on Qt's connection, handled on dispatchEvents()
+        KeyboardModel *m_model { nullptr };
+        QVector<xcb_generic_event_t> m_pending;
     };
 }
 
@@ -0,0 +1,245 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "XkbRules.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QStandardPaths>
+#include <QVector>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace SDDM {
+    // bump when the layout of the cache changes
+    static const quint32 s_version = 2;
+    static const char s_magic[8] = { 'S', 'D', 'D', 'M', 'X', 'K', 'B', 'R' };
+
+    // followed by the entries
+    struct XkbRules::Header {
+        quint32 count;
+        quint32 reserved;
+    };
+
+    // sorted by name, the offsets point into the strings following the entries
+    struct XkbRules::Entry {
+        quint32 nameOffset;
+        quint32 nameLength;
+        quint32 descriptionOffset;
+        quint32 descriptionLength;
+    };
+
+    static int compareBytes(const char *a, qint64 aLength, const char *b, qint64 bLength) {
+        const int result = memcmp(a, b, size_t(qMin(aLength, bLength)));
+        if (result != 0)
+            return result;
+        return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+    }
+
+    XkbRules::XkbRules(const QString &rulesFile, const QString &cacheFile)
+        : m_rulesFile(rulesFile), m_cache(cacheFile, s_magic, s_version) {
+    }
+
+    XkbRules::~XkbRules() {
+    }
+
+    QString XkbRules::defaultRulesFile() {
+        QString root = qEnvironmentVariable("XKB_CONFIG_ROOT");
+        if (root.isEmpty())
+            root = QStringLiteral("/usr/share/X11/xkb");
+        return root + QStringLiteral("/rules/evdev.xml");
+    }
+
+    QString XkbRules::defaultCacheFile() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/xkb-rules.cache");
+    }
+
+    bool XkbRules::load() {
+        const QFileInfo info(m_rulesFile);
+        if (!info.exists()) {
+            qWarning() << "Cannot find the rules file" << m_rulesFile;
+            return false;
+        }
+
+        if (map(info))
+            return true;
+
+        qDebug() << "Building the layout cache from" << m_rulesFile;
+        return build(info);
+    }
+
+    int XkbRules::count() const {
+        if (!m_data)
+            return 0;
+
+        Header header;
+        memcpy(&header, m_data, sizeof(header));
+        return int(header.count);
+    }
+
+    QString XkbRules::description(const QString &name) const {
+        if (!m_data)
+            return QString();
+
+        Header header;
+        memcpy(&header, m_data, sizeof(header));
+
+        const QByteArray key = name.toUtf8();
+        const uchar *entries = m_data + sizeof(Header);
+        const uchar *strings = entries + header.count * sizeof(Entry);
+        const qint64 stringsSize = m_size - (strings - m_data);
+
+        int low = 0;
+        int high = int(header.count) - 1;
+        while (low <= high) {
+            const int middle = (low + high) / 2;
+
+            Entry entry;
+            memcpy(&entry, entries + middle * sizeof(Entry), sizeof(entry));
+            if (qint64(entry.nameOffset) + entry.nameLength > stringsSize
+                    || qint64(entry.descriptionOffset) + entry.descriptionLength > stringsSize) {
+                qWarning() << "The layout cache" << m_cache.fileName() << "is corrupt";
+                return QString();
+            }
+
+            const int result = compareBytes(reinterpret_cast<const char *>(strings + entry.nameOffset), entry.nameLength,
+                                            key.constData(), key.size());
+            if (result == 0)
+                return QString::fromUtf8(reinterpret_cast<const char *>(strings + entry.descriptionOffset), int(entry.descriptionLength));
+            if (result < 0)
+                low = middle + 1;
+            else
+                high = middle - 1;
+        }
+
+        return QString();
+    }
+
+    bool XkbRules::map(const QFileInfo &rules) {
+        if (!m_cache.map(rules))
+            return false;
+        if (!validate(m_cache.data(), m_cache.size())) {
+            m_cache.close();
+            return false;
+        }
+
+        m_data = m_cache.data();
+        m_size = m_cache.size();
+        return true;
+    }
+
+    bool XkbRules::validate(const uchar *data, qint64 size) const {
+        if (size < qint64(sizeof(Header)))
+            return false;
+
+        Header header;
+        memcpy(&header, data, sizeof(header));
+        return qint64(sizeof(Header)) + qint64(header.count) * qint64(sizeof(Entry)) <= size;
+    }
+
+    bool XkbRules::build(const QFileInfo &rules) {
+        QFile file(m_rulesFile);
+        if (!file.open(QFile::ReadOnly)) {
+            qWarning() << "Cannot open the rules file" << m_rulesFile;
+            return false;
+        }
+
+        // only the layouts and their variants are of interest, models and
+        // options have name and description elements too
+        QVector<QPair<QByteArray, QByteArray>> layouts;
+        bool inLayoutList = false;
+        bool inVariant = false;
+        QString layout, variant;
+
+        QXmlStreamReader reader(&file);
+        while (!reader.atEnd()) {
+            const auto token = reader.readNext();
+            if (token == QXmlStreamReader::StartElement) {
+                const auto name = reader.name();
+                if (name == QLatin1String("layoutList")) {
+                    inLayoutList = true;
+                } else if (!inLayoutList) {
+                    continue;
+                } else if (name == QLatin1String("layout")) {
+                    layout.clear();
+                    inVariant = false;
+                } else if (name == QLatin1String("variant")) {
+                    variant.clear();
+                    inVariant = true;
+                } else if (name == QLatin1String("name")) {
+                    (inVariant ? variant : layout) = reader.readElementText().trimmed();
+                } else if (name == QLatin1String("description")) {
+                    const QString description = reader.readElementText().trimmed();
+                    const QString key = inVariant ? QStringLiteral("%1(%2)").arg(layout, variant) : layout;
+                    if (!layout.isEmpty())
+                        layouts.append(qMakePair(key.toUtf8(), description.toUtf8()));
+                }
+            } else if (token == QXmlStreamReader::EndElement) {
+                const auto name = reader.name();
+                if (name == QLatin1String("layoutList"))
+                    inLayoutList = false;
+                else if (name == QLatin1String("variant"))
+                    inVariant = false;
+            }
+        }
+
+        if (reader.hasError()) {
+            qWarning() << "Failed to parse the rules file" << m_rulesFile << reader.errorString();
+            return false;
+        }
+
+        std::sort(layouts.begin(), layouts.end(), [](const QPair<QByteArray, QByteArray> &a, const QPair<QByteArray, QByteArray> &b) {
+            return compareBytes(a.first.constData(), a.first.size(), b.first.constData(), b.first.size()) < 0;
+        });
+
+        Header header;
+        header.count = quint32(layouts.size());
+        header.reserved = 0;
+
+        QByteArray entries;
+        QByteArray strings;
+        entries.reserve(layouts.size() * int(sizeof(Entry)));
+        for (const auto &layout : qAsConst(layouts)) {
+            Entry entry;
+            entry.nameOffset = quint32(strings.size());
+            entry.nameLength = quint32(layout.first.size());
+            strings.append(layout.first);
+            entry.descriptionOffset = quint32(strings.size());
+            entry.descriptionLength = quint32(layout.second.size());
+            strings.append(layout.second);
+            entries.append(reinterpret_cast<const char *>(&entry), int(sizeof(entry)));
+        }
+
+        m_buffer = QByteArray(reinterpret_cast<const char *>(&header), int(sizeof(header))) + entries + strings;
+
+        if (m_cache.write(rules, { m_buffer }) && map(rules)) {
+            m_buffer.clear();
+            return true;
+        }
+
+        m_data = reinterpret_cast<const uchar *>(m_buffer.constData());
+        m_size = m_buffer.size();
+        return true;
+    }
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#ifndef SDDM_XKBRULES_H
+#define SDDM_XKBRULES_H
+
+#include "CacheFile.h"
+
+#include <QByteArray>
+#include <QString>
+
+class QFileInfo;
+
+namespace SDDM {
+    /**
+     * Layout descriptions from the xkb rules, e.g. "de(nodeadkeys)" to
+     * "German (no dead keys)".
+     *
+     * Parsing evdev.xml takes long, so the layouts are kept in a binary
+     * cache that is rebuilt whenever the rules file changes. The cache is
+     * mapped and only the descriptions asked for are decoded.
+     */
+    class XkbRules {
+    public:
+        XkbRules(const QString &rulesFile, const QString &cacheFile);
+        ~XkbRules();
+
+        static QString defaultRulesFile();
+        static QString defaultCacheFile();
+
+        bool load();
+
+        int count() const;
+        // name is a layout, optionally followed by the variant in parentheses
+        QString description(const QString &name) const;
+
+    private:
+        struct Header;
+        struct Entry;
+
+        bool map(const QFileInfo &rules);
+        bool build(const QFileInfo &rules);
+        bool validate(const uchar *data, qint64 size) const;
+
+        QString m_rulesFile;
+        CacheFile m_cache;
+
+        // either the mapped cache or, if it can't be written, m_buffer
+        const uchar *m_data { nullptr };
+        qint64 m_size { 0 };
+        QByteArray m_buffer;
+    };
+}
+
+#endif // SDDM_XKBRULES_H
@@ -51,6 +51,11 @@ Rectangle {
         function onInformationMessage(message) {
             txtMessage.text = message
         }
+
+        function onPowerActionFinished(action, success, errorMessage) {
+            if (!success)
+                txtMessage.text = errorMessage
+        }
     }
 
     Background {
@@ -90,6 +95,10 @@ Rectangle {
 
                 onLogin: sddm.login(model.name, password, sessionIndex);
 
+                // preselect the session this user picked last time
+                ListView.onIsCurrentItemChanged: if (ListView.isCurrentItem) sessionModel.user = model.name
+                Component.onCompleted: if (ListView.isCurrentItem) sessionModel.user = model.name
+
                 MouseArea {
                     anchors.fill: parent
                     onClicked: {
@@ -20,21 +20,38 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 ***************************************************************************/
 
-#include <QDir>
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
 #include <QDebug>
-#include <QGuiApplication>
-#include <QInputMethod>
 
 #include "KeyboardModel.h"
 #include "KeyboardModel_p.h"
 #include "KeyboardLayout.h"
 #include "waylandkeyboardbackend.h"
-#include <qxmlstream.h>
 
 namespace SDDM {
 
+static QDBusMessage layoutsCall(const QString &method)
+{
+    return QDBusMessage::createMethodCall(QStringLiteral("org.kde.keyboard"), QStringLiteral("/Layouts"),
+                                          QStringLiteral("org.kde.KeyboardLayouts"), method);
+}
+
+static bool queryCompositor(const QString &method, QDBusMessage &reply)
+{
+    reply = QDBusConnection::sessionBus().call(layoutsCall(method));
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) {
+        qWarning() << "Failed to call" << method << "on the compositor:" << reply.errorMessage();
+        return false;
+    }
+    return true;
+}
+
 WaylandKeyboardBackend::WaylandKeyboardBackend(KeyboardModelPrivate *kmp)
     : KeyboardBackend(kmp)
+    , m_rules(XkbRules::defaultRulesFile(), XkbRules::defaultCacheFile())
 {
 }
 
@@ -42,60 +59,79 @@ WaylandKeyboardBackend::~WaylandKeyboardBackend()
 {
 }
 
-
-QList<QObject *> parseRules(const QString &filename, int &current)
+void WaylandKeyboardBackend::init()
 {
-    // FIXME: https://github.com/sddm/sddm/pull/1664#discussion_r1115361314
-    current = 0;
-    QFile file(filename);
-    qDebug() << "Parsing xkb rules from" << file.fileName();
-    if (!file.open(QFile::ReadOnly | QFile::Text)) {
-        qWarning() << "Cannot open the rules file" << file.fileName();
-        return {};
-    }
+    if (initCompositorLayouts())
+        return;
 
-    QList<QObject *> layouts;
+    // themes only offer to change the layout when enabled
+    d->enabled = false;
+    initDefaultLayouts();
+}
 
-    QString lastName, lastDescription;
+bool WaylandKeyboardBackend::initCompositorLayouts()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected() || !bus.interface()->isServiceRegistered(QStringLiteral("org.kde.keyboard")))
+        return false;
+
+    m_compositor = true;
+    dispatchEvents();
+    if (m_names.isEmpty()) {
+        m_compositor = false;
+        return false;
+    }
 
-    QStringList path;
-    QXmlStreamReader reader(&file);
-    while (!reader.atEnd()) {
-        const auto token = reader.readNext();
-        if (token == QXmlStreamReader::StartElement) {
-            path << reader.name().toString();
-            QString strPath = path.join(QLatin1String("/"));
+    qDebug() << "Switching keyboard layouts through the compositor:" << m_names;
+    return true;
+}
 
-            if (strPath.endsWith(QLatin1String("layoutList/layout/configItem/name"))) {
-                lastName = reader.readElementText().trimmed();
-            } else if (strPath.endsWith(QLatin1String("layoutList/layout/configItem/description"))) {
-                // TODO: This should be translated using i18nd("xkeyboard-config", lastDescription)
-                lastDescription = reader.readElementText().trimmed();
-            }
-        }
-        // don't use token here, readElementText() above can have moved us forward meanwhile
-        if (reader.tokenType() == QXmlStreamReader::EndElement) {
-            const QString strPath = path.join(QLatin1String("/"));
-            if (strPath.endsWith(QLatin1String("layoutList/layout/configItem/description"))) {
-                layouts << new KeyboardLayout(lastName, lastDescription);
-            }
-            path.removeLast();
-        }
+void WaylandKeyboardBackend::initDefaultLayouts()
+{
+    // compositors build their default keymap from these
+    const QStringList layouts = qEnvironmentVariable("XKB_DEFAULT_LAYOUT").split(QLatin1Char(','));
+    const QStringList variants = qEnvironmentVariable("XKB_DEFAULT_VARIANT").split(QLatin1Char(','));
+
+    QStringList names, descriptions;
+    for (int i = 0; i < layouts.size(); ++i) {
+        const QString layout = layouts.at(i).trimmed();
+        if (layout.isEmpty())
+            continue;
+
+        const QString variant = i < variants.size() ? variants.at(i).trimmed() : QString();
+        const QString name = variant.isEmpty() ? layout : QStringLiteral("%1(%2)").arg(layout, variant);
+        names << name;
+        descriptions << describe(name, QString());
     }
 
-    if (reader.hasError()) {
-        qWarning() << "Failed to parse the rules file" << file.fileName();
-        return {};
-    }
-    return layouts;
+    setLayouts(names, descriptions);
+    d->layout_id = 0;
 }
 
-void WaylandKeyboardBackend::init()
+void WaylandKeyboardBackend::setLayouts(const QStringList &names, const QStringList &descriptions)
 {
-    // TODO: We can't actually switch keyboard layout yet, so don't populate a list of layouts
-    // so that themes can know to not show the option to change layout
-    // d->layouts = parseRules(QStringLiteral("/usr/share/X11/xkb/rules/evdev.xml"), d->layout_id);
-    d->enabled = false;
+    d->layouts.clear();
+    d->layouts.reserve(names.size());
+    for (int i = 0; i < names.size(); ++i)
+        d->layouts << KeyboardLayout(names.at(i).section(QLatin1Char('('), 0, 0), descriptions.at(i));
+    m_names = names;
+}
+
+QString WaylandKeyboardBackend::describe(const QString &name, const QString &fallback)
+{
+    if (!fallback.isEmpty())
+        return fallback;
+
+    // the rules are only needed when the compositor doesn't describe its layouts
+    if (!m_rulesLoaded) {
+        m_rules.load();
+        m_rulesLoaded = true;
+    }
+
+    QString description = m_rules.description(name);
+    if (description.isEmpty() && name.contains(QLatin1Char('(')))
+        description = m_rules.description(name.section(QLatin1Char('('), 0, 0));
+    return description.isEmpty() ? name : description;
 }
 
 void WaylandKeyboardBackend::disconnect()
@@ -104,15 +140,56 @@ void WaylandKeyboardBackend::disconnect()
 
 void WaylandKeyboardBackend::sendChanges()
 {
+    // there's nothing like LED control for clients on Wayland
+    if (!m_compositor || d->layout_id == m_compositorLayout || d->layout_id < 0 || d->layout_id >= m_names.size())
+        return;
+
+    QDBusMessage call = layoutsCall(QStringLiteral("setLayout"));
+    call << uint(d->layout_id);
+    QDBusConnection::sessionBus().asyncCall(call);
+    m_compositorLayout = d->layout_id;
 }
 
 void WaylandKeyboardBackend::dispatchEvents()
 {
+    if (!m_compositor)
+        return;
+
+    QDBusMessage reply;
+    if (queryCompositor(QStringLiteral("getLayoutsList"), reply)) {
+        QStringList names, descriptions;
+        const QDBusArgument argument = reply.arguments().constFirst().value<QDBusArgument>();
+        argument.beginArray();
+        while (!argument.atEnd()) {
+            QString shortName, displayName, longName;
+            argument.beginStructure();
+            argument >> shortName >> displayName >> longName;
+            argument.endStructure();
+            names << shortName;
+            descriptions << describe(shortName, longName);
+        }
+        argument.endArray();
+
+        if (names != m_names)
+            setLayouts(names, descriptions);
+    }
+
+    if (queryCompositor(QStringLiteral("getLayout"), reply)) {
+        m_compositorLayout = int(reply.arguments().constFirst().toUInt());
+        d->layout_id = m_compositorLayout;
+    }
 }
 
 void WaylandKeyboardBackend::connectEventsDispatcher(KeyboardModel *model)
 {
-    Q_UNUSED(model);
+    if (!m_compositor)
+        return;
+
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    bus.connect(QStringLiteral("org.kde.keyboard"), QStringLiteral("/Layouts"), QStringLiteral("org.kde.KeyboardLayouts"),
+                QStringLiteral("layoutChanged"), model, SLOT(dispatchEvents()));
+    bus.connect(QStringLiteral("org.kde.keyboard"), QStringLiteral("/Layouts"), QStringLiteral("org.kde.KeyboardLayouts"),
+                QStringLiteral("layoutListChanged"), model, SLOT(dispatchEvents()));
 }
 
 } // namespace SDDM
@@ -21,9 +21,18 @@
 #define WAYLANDKEYBOARDBACKEND_H
 
 #include "KeyboardBackend.h"
+#include "XkbRules.h"
+
+#include <QStringList>
 
 namespace SDDM {
 
+/**
+ * Wayland has no protocol for clients to change the keyboard layout, so
+ * layouts are switched through the compositor's D-Bus interface where it
+ * offers one (KWin's org.kde.KeyboardLayouts). Otherwise the layouts the
+ * compositor was started with are listed, but can't be switched.
+ */
 class WaylandKeyboardBackend : public KeyboardBackend
 {
 public:
@@ -36,6 +45,20 @@ public:
     void dispatchEvents() override;
 
     void connectEventsDispatcher(KeyboardModel *model) override;
+
+private:
+    bool initCompositorLayouts();
+    void initDefaultLayouts();
+    void setLayouts(const QStringList &names, const QStringList &descriptions);
+    QString describe(const QString &name, const QString &fallback);
+
+    XkbRules m_rules;
+    bool m_rulesLoaded { false };
+
+    // layouts can be switched through the compositor
+    bool m_compositor { false };
+    QStringList m_names;
+    int m_compositorLayout { -1 };
 };
 
 } // namespace SDDM
@@ -22,9 +22,13 @@
 #include "HelperApp.h"
 
 #include "backend/PamBackend.h"
+#ifdef ENABLE_MOCK_AUTH
+#include "backend/MockBackend.h"
+#endif
 #include "Configuration.h"
 #include "UserSession.h"
 
+#include <QtCore/QDebug>
 #include <QtCore/QProcessEnvironment>
 
 #include <pwd.h>
@@ -42,9 +46,26 @@ namespace SDDM {
 
     Backend *Backend::get(HelperApp* parent)
     {
+        // name[:options]
+        const QStringList args = parent->arguments();
+        const int pos = args.indexOf(QStringLiteral("--backend"));
+        const QString backend = pos >= 0 && pos < args.length() - 1 ? args[pos + 1] : QString();
+        const QString name = backend.section(QLatin1Char(':'), 0, 0);
+
+#ifdef ENABLE_MOCK_AUTH
+        if (name == QLatin1String("mock"))
+            return new MockBackend(parent, backend.section(QLatin1Char(':'), 1));
+#endif
+        if (!name.isEmpty() && name != QLatin1String("pam"))
+            qWarning() << "Authentication backend" << name << "is not available, using PAM";
+
         return new PamBackend(parent);
     }
 
+    bool Backend::needsRoot() const {
+        return true;
+    }
+
     void Backend::setAutologin(bool on) {
         m_autologin = on;
     }
@@ -119,6 +140,10 @@ namespace SDDM {
         }
         // TODO: I'm fairly sure this shouldn't be done for PAM sessions, investigate!
         m_app->session()->setProcessEnvironment(env);
+
+        // credentials are established by now, so the groups are final
+        if (!m_app->session()->resolveGroups())
+            return false;
         return m_app->session()->start();
     }
 
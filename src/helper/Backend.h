@@ -31,10 +31,16 @@ namespace SDDM {
     public:
         /**
         * Requests allocation of a new backend instance.
-        * The method chooses the most suitable one for the current system.
+        * The method chooses the most suitable one for the current system,
+        * unless one was asked for with --backend.
         */
         static Backend *get(HelperApp *parent);
 
+        /**
+        * Whether the helper has to run as root with this backend.
+        */
+        virtual bool needsRoot() const;
+
         void setAutologin(bool on = true);
         void setDisplayServer(bool on = true);
         void setGreeter(bool on = true);
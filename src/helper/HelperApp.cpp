@@ -24,6 +24,7 @@
 #include "UserSession.h"
 #include "SafeDataStream.h"
 
+#include "AsyncLogger.h"
 #include "MessageHandler.h"
 #include "VirtualTerminal.h"
 #include "SignalHandler.h"
@@ -150,7 +151,7 @@ namespace SDDM {
             return;
         }
 
-        Q_ASSERT(getuid() == 0);
+        Q_ASSERT(getuid() == 0 || !m_backend->needsRoot());
         if (!m_backend->authenticate()) {
             authenticated(QString());
 
@@ -181,6 +182,9 @@ namespace SDDM {
 
             // write successful login to utmp/wtmp
             const QProcessEnvironment env = m_session->processEnvironment();
+            AsyncLogger::setField(AsyncLogger::Seat, env.value(QStringLiteral("XDG_SEAT")));
+            AsyncLogger::setField(AsyncLogger::Display, env.value(QStringLiteral("DISPLAY")));
+            AsyncLogger::setField(AsyncLogger::LoginId, env.value(QStringLiteral("XDG_SESSION_ID")));
             const QString displayId = env.value(QStringLiteral("DISPLAY"));
             const QString vt = env.value(QStringLiteral("XDG_VTNR"));
             if (env.value(QStringLiteral("XDG_SESSION_CLASS")) != QLatin1String("greeter")) {
@@ -247,7 +251,7 @@ namespace SDDM {
     void HelperApp::sessionOpened(bool success) {
         Msg m = Msg::MSG_UNKNOWN;
         SafeDataStream str(m_socket);
-        str << Msg::SESSION_STATUS << success;
+        str << Msg::SESSION_STATUS << success << m_session->groupLookupTime() << m_session->vtSwitchTime();
         str.send();
         str.receive();
         str >> m;
@@ -282,7 +286,7 @@ namespace SDDM {
     }
 
     HelperApp::~HelperApp() {
-        Q_ASSERT(getuid() == 0);
+        Q_ASSERT(getuid() == 0 || !m_backend->needsRoot());
 
         m_session->stop();
         m_backend->closeSession();
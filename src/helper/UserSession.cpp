@@ -19,18 +19,23 @@
  *
  */
 
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QSocketNotifier>
 
 #include "Configuration.h"
 #include "Constants.h"
 #include "UserSession.h"
 #include "HelperApp.h"
+#include "ProcessReaper.h"
 #include "VirtualTerminal.h"
 #include "XAuth.h"
 
+#include <algorithm>
 #include <functional>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
@@ -48,6 +53,12 @@ namespace SDDM {
         : QProcess(parent)
     {
         connect(this, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &UserSession::finished);
+        // the cookie is of no use once the session is gone
+        connect(this, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this] {
+            if (!m_xauthFile.fileName().isEmpty())
+                m_xauthFile.remove();
+        });
+        ProcessReaper::supervise(this);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
         setChildProcessModifier(std::bind(&UserSession::childModifier, this));
 #endif
@@ -60,8 +71,8 @@ namespace SDDM {
         bool isWaylandGreeter = false;
 
         // If the Xorg display server was already started, write the passed
-        // auth cookie to /tmp/xauth_XXXXXX. This is done in the parent process
-        // so that it can clean up the file on session end.
+        // auth cookie to $XDG_RUNTIME_DIR/xauth_XXXXXX. This is done in the
+        // parent process so that it can clean up the file on session end.
         if (env.value(QStringLiteral("XDG_SESSION_TYPE")) == QLatin1String("x11")
             && m_displayServerCmd.isEmpty()) {
             // Create the Xauthority file
@@ -71,10 +82,14 @@ namespace SDDM {
                 return false;
             }
 
-            // Place it into /tmp, which is guaranteed to be read/writeable by
-            // everyone while having the sticky bit set to avoid messing with
-            // other's files.
-            m_xauthFile.setFileTemplate(QStringLiteral("/tmp/xauth_XXXXXX"));
+            // Prefer the user's runtime dir, a tmpfs that goes away with the
+            // last session even if we crash. Otherwise place it into /tmp,
+            // which is guaranteed to be read/writeable by everyone while
+            // having the sticky bit set to avoid messing with other's files.
+            QString xauthDir = env.value(QStringLiteral("XDG_RUNTIME_DIR"));
+            if (xauthDir.isEmpty() || !QFileInfo(xauthDir).isDir())
+                xauthDir = QStringLiteral("/tmp");
+            m_xauthFile.setFileTemplate(xauthDir + QStringLiteral("/xauth_XXXXXX"));
 
             if (!m_xauthFile.open()) {
                 qCritical() << "Could not create the Xauthority file";
@@ -93,6 +108,21 @@ namespace SDDM {
             setProcessEnvironment(env);
         }
 
+        if (!prepareChild()) {
+            releaseChild();
+            return false;
+        }
+
+        // Switch to the session's VT from here, the child is kept to the bare minimum
+        if (m_child.ownsTty && m_child.vtNumber > 0) {
+            const bool x11UserSession = env.value(QStringLiteral("XDG_SESSION_TYPE")) == QLatin1String("x11")
+                    && env.value(QStringLiteral("XDG_SESSION_CLASS")) == QLatin1String("user");
+            QElapsedTimer timer;
+            timer.start();
+            if (VirtualTerminal::jumpToVt(m_child.vtNumber, x11UserSession))
+                m_vtSwitchTime = timer.elapsed();
+        }
+
         if (env.value(QStringLiteral("XDG_SESSION_TYPE")) == QLatin1String("x11")) {
             QString command;
             if (env.value(QStringLiteral("XDG_SESSION_CLASS")) == QLatin1String("greeter")) {
@@ -130,6 +160,7 @@ namespace SDDM {
         } else {
             qCritical() << "Unable to run user session: unknown session type";
         }
+        releaseChild();
 
         const bool started = waitForStarted();
         m_cachedProcessId = processId();
@@ -146,16 +177,10 @@ namespace SDDM {
     void UserSession::stop()
     {
         if (state() != QProcess::NotRunning) {
-            terminate();
             const bool isGreeter = processEnvironment().value(QStringLiteral("XDG_SESSION_CLASS")) == QLatin1String("greeter");
 
             // Wait longer for a session than a greeter
-            if (!waitForFinished(isGreeter ? 5000 : 60000)) {
-                kill();
-                if (!waitForFinished(5000)) {
-                    qWarning() << "Could not fully finish the process" << program();
-                }
-            }
+            ProcessReaper::terminate(this, isGreeter ? 5000 : 60000);
         } else {
             Q_EMIT finished(Auth::HELPER_OTHER_ERROR);
         }
@@ -179,209 +204,260 @@ namespace SDDM {
         return m_path;
     }
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    void UserSession::childModifier() {
-#else
-    void UserSession::setupChildProcess() {
-#endif
-        // Session type
-        QString sessionType = processEnvironment().value(QStringLiteral("XDG_SESSION_TYPE"));
-        QString sessionClass = processEnvironment().value(QStringLiteral("XDG_SESSION_CLASS"));
+    bool UserSession::prepareChild() {
+        releaseChild();
+        m_child = ChildSetup();
+        if (m_childErrorNotifier) {
+            m_childErrorNotifier->deleteLater();
+            m_childErrorNotifier = nullptr;
+            ::close(m_childErrorFd);
+            m_childErrorFd = -1;
+        }
+
+        const QProcessEnvironment env = processEnvironment();
+        const QString sessionType = env.value(QStringLiteral("XDG_SESSION_TYPE"));
+        const QString sessionClass = env.value(QStringLiteral("XDG_SESSION_CLASS"));
         const bool hasDisplayServer = !m_displayServerCmd.isEmpty();
-        const bool x11UserSession = sessionType == QLatin1String("x11") && sessionClass == QLatin1String("user");
         const bool waylandUserSession = sessionType == QLatin1String("wayland") && sessionClass == QLatin1String("user");
 
         // When the display server is part of the session, we leak the VT into
         // the session as stdin so that it stays open without races
         if (hasDisplayServer || waylandUserSession) {
-            // open VT and get the fd
-            int vtNumber = processEnvironment().value(QStringLiteral("XDG_VTNR")).toInt();
-            QString ttyString = VirtualTerminal::path(vtNumber);
-            int vtFd = ::open(qPrintable(ttyString), O_RDWR | O_NOCTTY);
-
-            // when this is true we'll take control of the tty
-            bool takeControl = false;
-
-            if (vtNumber > 0 && vtFd > 0) {
-                dup2(vtFd, STDIN_FILENO);
-                ::close(vtFd);
-                takeControl = true;
-            } else {
-                int stdinFd = ::open("/dev/null", O_RDWR);
-                dup2(stdinFd, STDIN_FILENO);
-                ::close(stdinFd);
-            }
-
-            // set this process as session leader
-            if (setsid() < 0) {
-                qCritical("Failed to set pid %lld as leader of the new session and process group: %s",
-                          QCoreApplication::applicationPid(), strerror(errno));
-                _exit(Auth::HELPER_OTHER_ERROR);
-            }
-
-            // take control of the tty
-            if (takeControl) {
-                if (ioctl(STDIN_FILENO, TIOCSCTTY) < 0) {
-                    const auto error = strerror(errno);
-                    qCritical().nospace() << "Failed to take control of " << ttyString << " (" << QFileInfo(ttyString).owner() << "): " << error;
-                    _exit(Auth::HELPER_TTY_ERROR);
-                }
-            }
-
-            if (vtNumber > 0)
-                VirtualTerminal::jumpToVt(vtNumber, x11UserSession);
+            m_child.ownsTty = true;
+            m_child.vtNumber = env.value(QStringLiteral("XDG_VTNR")).toInt();
+            if (m_child.vtNumber > 0)
+                m_child.ttyPath = QFile::encodeName(VirtualTerminal::path(m_child.vtNumber));
         }
 
 #ifdef Q_OS_LINUX
-        // enter Linux namespaces
+        // open the Linux namespaces to enter
         for (const QString &ns: mainConfig.Namespaces.get()) {
             qInfo() << "Entering namespace" << ns;
-            int fd = ::open(qPrintable(ns), O_RDONLY);
+            int fd = ::open(qPrintable(ns), O_RDONLY | O_CLOEXEC);
             if (fd < 0) {
                 qCritical("open(%s) failed: %s", qPrintable(ns), strerror(errno));
-                exit(Auth::HELPER_OTHER_ERROR);
-            }
-            if (setns(fd, 0) != 0) {
-                qCritical("setns(open(%s), 0) failed: %s", qPrintable(ns), strerror(errno));
-                exit(Auth::HELPER_OTHER_ERROR);
+                return false;
             }
-            ::close(fd);
+            m_child.namespaceFds << fd;
+            m_child.namespaces << ns;
         }
 #endif
 
-        // switch user
+        // look up the user
         const QByteArray username = qobject_cast<HelperApp*>(parent())->user().toLocal8Bit();
-        struct passwd pw;
         struct passwd *rpw;
         long bufsize = sysconf(_SC_GETPW_R_SIZE_MAX);
         if (bufsize == -1)
             bufsize = 16384;
-        QScopedPointer<char, QScopedPointerPodDeleter> buffer(static_cast<char*>(malloc(bufsize)));
-        if (buffer.isNull()) {
-            qCritical() << "Could not allocate buffer of size" << bufsize;
-            exit(Auth::HELPER_OTHER_ERROR);
-        }
-        int err = getpwnam_r(username.constData(), &pw, buffer.data(), bufsize, &rpw);
+        m_child.pwBuffer.resize(bufsize);
+        int err = getpwnam_r(username.constData(), &m_child.pw, m_child.pwBuffer.data(), m_child.pwBuffer.size(), &rpw);
         if (rpw == NULL) {
             if (err == 0)
                 qCritical() << "getpwnam_r(" << username << ") username not found!";
             else
                 qCritical() << "getpwnam_r(" << username << ") failed with error: " << strerror(err);
-            exit(Auth::HELPER_OTHER_ERROR);
+            return false;
         }
 
         const int xauthHandle = m_xauthFile.handle();
-        if (xauthHandle != -1 && fchown(xauthHandle, pw.pw_uid, pw.pw_gid) != 0) {
+        if (xauthHandle != -1 && fchown(xauthHandle, m_child.pw.pw_uid, m_child.pw.pw_gid) != 0) {
             qCritical() << "fchown failed for" << m_xauthFile.fileName();
-            exit(Auth::HELPER_OTHER_ERROR);
+            return false;
         }
 
-#if defined(Q_OS_FREEBSD)
-        // execve() uses the environment prepared in Backend::openSession(),
-        // therefore environment variables which are set here are ignored.
-        if (setusercontext(NULL, &pw, pw.pw_uid, LOGIN_SETALL) != 0) {
-            qCritical() << "setusercontext(NULL, *, " << pw.pw_uid << ", LOGIN_SETALL) failed for user: " << username;
-            exit(Auth::HELPER_OTHER_ERROR);
-        }
-#else
-        if (setgid(pw.pw_gid) != 0) {
-            qCritical() << "setgid(" << pw.pw_gid << ") failed for user: " << username;
-            exit(Auth::HELPER_OTHER_ERROR);
+#ifndef Q_OS_FREEBSD
+        // usually resolved already right after PAM's setcred
+        if (!resolveGroups())
+            return false;
+        m_child.groups = m_groups;
+#endif
+
+        if (sessionClass != QLatin1String("greeter")) {
+            // determine stderr log file based on session type, the child
+            // creates it once it runs as the user, so that the user owns it
+            const QString sessionLog = QStringLiteral("%1/%2")
+                    .arg(QString::fromLocal8Bit(m_child.pw.pw_dir))
+                    .arg(sessionType == QLatin1String("x11")
+                         ? mainConfig.X11.SessionLogFile.get()
+                         : mainConfig.Wayland.SessionLogFile.get());
+            m_child.sessionLog = QFile::encodeName(sessionLog);
+
+            // every directory leading to it, existing ones are skipped by mkdir()
+            const QString logDir = QFileInfo(sessionLog).absolutePath();
+            for (int i = logDir.indexOf(QLatin1Char('/'), 1); i != -1; i = logDir.indexOf(QLatin1Char('/'), i + 1))
+                m_child.logDirs << QFile::encodeName(logDir.left(i));
+            m_child.logDirs << QFile::encodeName(logDir);
         }
 
-        // fetch ambient groups from PAM's environment;
-        // these are set by modules such as pam_groups.so
-        int n_pam_groups = getgroups(0, NULL);
-        gid_t *pam_groups = NULL;
-        if (n_pam_groups > 0) {
-            pam_groups = new gid_t[n_pam_groups];
-            if ((n_pam_groups = getgroups(n_pam_groups, pam_groups)) == -1) {
-                qCritical() << "getgroups() failed to fetch supplemental"
-                            << "PAM groups for user:" << username;
-                exit(Auth::HELPER_OTHER_ERROR);
-            }
-        } else {
-            n_pam_groups = 0;
+        // failures in the child are sent back through this pipe, which is
+        // closed by exec() when everything went fine
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+            qCritical("Failed to create pipe for the session process: %s", strerror(errno));
+            return false;
         }
+        m_childErrorFd = fds[0];
+        m_child.errorPipe = fds[1];
+        m_childErrorNotifier = new QSocketNotifier(m_childErrorFd, QSocketNotifier::Read, this);
+        connect(m_childErrorNotifier, &QSocketNotifier::activated, this, &UserSession::readChildErrors);
 
-        // fetch session's user's groups
-        int n_user_groups = 0;
-        gid_t *user_groups = NULL;
-        if (-1 == getgrouplist(pw.pw_name, pw.pw_gid,
-                               NULL, &n_user_groups)) {
-            user_groups = new gid_t[n_user_groups];
-            if ((n_user_groups = getgrouplist(pw.pw_name,
-                                              pw.pw_gid, user_groups,
-                                              &n_user_groups)) == -1 ) {
-                qCritical() << "getgrouplist(" << pw.pw_name << ", " << pw.pw_gid
-                            << ") failed";
-                exit(Auth::HELPER_OTHER_ERROR);
-            }
+        return true;
+    }
+
+    void UserSession::releaseChild() {
+        // the child has its own copies by now
+        for (int fd : qAsConst(m_child.namespaceFds))
+            ::close(fd);
+        m_child.namespaceFds.clear();
+        if (m_child.errorPipe != -1) {
+            ::close(m_child.errorPipe);
+            m_child.errorPipe = -1;
         }
+    }
 
-        // set groups to concatenation of PAM's ambient
-        // groups and the session's user's groups
-        int n_groups = n_pam_groups + n_user_groups;
-        if (n_groups > 0) {
-            gid_t *groups = new gid_t[n_groups];
-            memcpy(groups, pam_groups, (n_pam_groups * sizeof(gid_t)));
-            memcpy((groups + n_pam_groups), user_groups,
-                   (n_user_groups * sizeof(gid_t)));
-
-            // setgroups(2) handles duplicate groups
-            if (setgroups(n_groups, groups) != 0) {
+    void UserSession::readChildErrors() {
+        struct { int step; int error; } record;
+        ssize_t length;
+        while ((length = ::read(m_childErrorFd, &record, sizeof(record))) == sizeof(record)) {
+            const QByteArray username = m_child.pw.pw_name;
+            const char *error = strerror(record.error);
+            switch (record.step) {
+            case Setsid:
+                qCritical("Failed to set pid %lld as leader of the new session and process group: %s",
+                          m_cachedProcessId, error);
+                break;
+            case TakeTty: {
+                const QString ttyString = QFile::decodeName(m_child.ttyPath);
+                qCritical().nospace() << "Failed to take control of " << ttyString << " (" << QFileInfo(ttyString).owner() << "): " << error;
+                break;
+            }
+            case EnterNamespace:
+                qCritical("setns() failed for one of %s: %s", qPrintable(m_child.namespaces.join(QLatin1Char(' '))), error);
+                break;
+            case SetUserContext:
+                qCritical() << "setusercontext(NULL, *, " << m_child.pw.pw_uid << ", LOGIN_SETALL) failed for user: " << username;
+                break;
+            case SetGid:
+                qCritical() << "setgid(" << m_child.pw.pw_gid << ") failed for user: " << username;
+                break;
+            case SetGroups:
                 qCritical() << "setgroups() failed for user: " << username;
-                exit (Auth::HELPER_OTHER_ERROR);
+                break;
+            case SetUid:
+                qCritical() << "setuid(" << m_child.pw.pw_uid << ") failed for user: " << username;
+                break;
+            case ChangeDir:
+                qCritical() << "chdir(" << m_child.pw.pw_dir << ") failed for user: " << username;
+                qCritical() << "verify directory exist and has sufficient permissions";
+                break;
+            case OpenSessionLog:
+                qWarning() << "Could not open stderr to" << QFile::decodeName(m_child.sessionLog) << ":" << error;
+                break;
+            case RedirectStdout:
+                qWarning() << "Could not redirect stdout";
+                break;
             }
-            delete[] groups;
         }
-        delete[] pam_groups;
-        delete[] user_groups;
 
-        if (setuid(pw.pw_uid) != 0) {
-            qCritical() << "setuid(" << pw.pw_uid << ") failed for user: " << username;
-            exit(Auth::HELPER_OTHER_ERROR);
+        // closed on exec or exit
+        if (length == 0 || (length < 0 && errno != EAGAIN && errno != EINTR)) {
+            m_childErrorNotifier->deleteLater();
+            m_childErrorNotifier = nullptr;
+            ::close(m_childErrorFd);
+            m_childErrorFd = -1;
         }
-#endif /* Q_OS_FREEBSD */
-        if (chdir(pw.pw_dir) != 0) {
-            qCritical() << "chdir(" << pw.pw_dir << ") failed for user: " << username;
-            qCritical() << "verify directory exist and has sufficient permissions";
-            exit(Auth::HELPER_OTHER_ERROR);
+    }
+
+    void UserSession::childFailed(ChildStep step, int exitCode, bool fatal) const {
+        // only async-signal-safe calls from here on
+        const struct { int step; int error; } record { step, errno };
+        if (m_child.errorPipe != -1 && ::write(m_child.errorPipe, &record, sizeof(record)) < 0) {
+            // nothing we can do about it
         }
+        if (fatal)
+            _exit(exitCode);
+    }
 
-        if (sessionClass != QLatin1String("greeter")) {
-            //we cannot use setStandardError file as this code is run in the child process
-            //we want to redirect after we setuid so that the log file is owned by the user
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    void UserSession::childModifier() {
+#else
+    void UserSession::setupChildProcess() {
+#endif
+        // This runs between fork and exec: everything was looked up and
+        // allocated by prepareChild(), keep it to plain syscalls
+        const ChildSetup &setup = m_child;
 
-            // determine stderr log file based on session type
-            QString sessionLog = QStringLiteral("%1/%2")
-                    .arg(QString::fromLocal8Bit(pw.pw_dir))
-                    .arg(sessionType == QLatin1String("x11")
-                         ? mainConfig.X11.SessionLogFile.get()
-                         : mainConfig.Wayland.SessionLogFile.get());
+        if (setup.ownsTty) {
+            // open VT and get the fd
+            int vtFd = setup.ttyPath.isEmpty() ? -1 : ::open(setup.ttyPath.constData(), O_RDWR | O_NOCTTY);
+
+            // when this is true we'll take control of the tty
+            const bool takeControl = vtFd > 0;
+
+            if (!takeControl)
+                vtFd = ::open("/dev/null", O_RDWR);
+            dup2(vtFd, STDIN_FILENO);
+            ::close(vtFd);
+
+            // set this process as session leader
+            if (setsid() < 0)
+                childFailed(Setsid, Auth::HELPER_OTHER_ERROR);
+
+            // take control of the tty
+            if (takeControl && ioctl(STDIN_FILENO, TIOCSCTTY) < 0)
+                childFailed(TakeTty, Auth::HELPER_TTY_ERROR);
+        }
+
+#ifdef Q_OS_LINUX
+        // enter Linux namespaces
+        for (int fd : setup.namespaceFds) {
+            if (setns(fd, 0) != 0)
+                childFailed(EnterNamespace, Auth::HELPER_OTHER_ERROR);
+        }
+#endif
+
+        // switch user
+#if defined(Q_OS_FREEBSD)
+        // execve() uses the environment prepared in Backend::openSession(),
+        // therefore environment variables which are set here are ignored.
+        if (setusercontext(NULL, const_cast<struct passwd *>(&setup.pw), setup.pw.pw_uid, LOGIN_SETALL) != 0)
+            childFailed(SetUserContext, Auth::HELPER_OTHER_ERROR);
+#else
+        if (setgid(setup.pw.pw_gid) != 0)
+            childFailed(SetGid, Auth::HELPER_OTHER_ERROR);
+
+        // PAM's ambient groups and the session's user's groups
+        if (!setup.groups.isEmpty() && setgroups(setup.groups.size(), setup.groups.constData()) != 0)
+            childFailed(SetGroups, Auth::HELPER_OTHER_ERROR);
+
+        if (setuid(setup.pw.pw_uid) != 0)
+            childFailed(SetUid, Auth::HELPER_OTHER_ERROR);
+#endif /* Q_OS_FREEBSD */
+        if (chdir(setup.pw.pw_dir) != 0)
+            childFailed(ChangeDir, Auth::HELPER_OTHER_ERROR);
 
-            // create the path
-            QFileInfo finfo(sessionLog);
-            QDir().mkpath(finfo.absolutePath());
+        if (!setup.sessionLog.isEmpty()) {
+            //we cannot use setStandardError file as this code is run in the child process
+            //we want to redirect after we setuid so that the log file is owned by the user
+            for (const QByteArray &dir : setup.logDirs)
+                ::mkdir(dir.constData(), 0777);
 
             //swap the stderr pipe of this subprcess into a file
-            int fd = ::open(qPrintable(sessionLog), O_WRONLY | O_CREAT | O_TRUNC, 0600);
-            if (fd >= 0)
-            {
-                dup2 (fd, STDERR_FILENO);
+            int fd = ::open(setup.sessionLog.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            if (fd >= 0) {
+                dup2(fd, STDERR_FILENO);
                 ::close(fd);
             } else {
-                qWarning() << "Could not open stderr to" << sessionLog;
+                childFailed(OpenSessionLog, 0, false);
             }
 
             //redirect any stdout to /dev/null
             fd = ::open("/dev/null", O_WRONLY);
-            if (fd >= 0)
-            {
-                dup2 (fd, STDOUT_FILENO);
+            if (fd >= 0) {
+                dup2(fd, STDOUT_FILENO);
                 ::close(fd);
             } else {
-                qWarning() << "Could not redirect stdout";
+                childFailed(RedirectStdout, 0, false);
             }
         }
     }
@@ -390,4 +466,70 @@ namespace SDDM {
         return m_cachedProcessId;
     }
 
+    bool UserSession::resolveGroups() {
+#if defined(Q_OS_FREEBSD)
+        // setusercontext() takes care of the groups
+        return true;
+#else
+        const QByteArray username = qobject_cast<HelperApp*>(parent())->user().toLocal8Bit();
+        if (m_groupLookupTime >= 0 && m_groupsUser == username)
+            return true;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        struct passwd *pw = getpwnam(username.constData());
+        if (!pw) {
+            qCritical() << "getpwnam(" << username << ") failed";
+            return false;
+        }
+
+        // fetch ambient groups from PAM's environment;
+        // these are set by modules such as pam_groups.so
+        QVector<gid_t> groups;
+        const int n_pam_groups = getgroups(0, NULL);
+        if (n_pam_groups > 0) {
+            groups.resize(n_pam_groups);
+            if (getgroups(n_pam_groups, groups.data()) == -1) {
+                qCritical() << "getgroups() failed to fetch supplemental"
+                            << "PAM groups for user:" << username;
+                return false;
+            }
+        }
+
+        // fetch session's user's groups, the buffer only has to grow for
+        // users with lots of groups, everybody else gets by with one lookup
+        QVector<gid_t> userGroups(64);
+        int n_user_groups = userGroups.size();
+        while (getgrouplist(pw->pw_name, pw->pw_gid, userGroups.data(), &n_user_groups) == -1) {
+            if (n_user_groups <= userGroups.size()) {
+                qCritical() << "getgrouplist(" << pw->pw_name << ", " << pw->pw_gid
+                            << ") failed";
+                return false;
+            }
+            userGroups.resize(n_user_groups);
+        }
+        userGroups.resize(n_user_groups);
+
+        // the concatenation of both, without duplicates
+        groups += userGroups;
+        std::sort(groups.begin(), groups.end());
+        groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+
+        m_groups = groups;
+        m_groupsUser = username;
+        m_groupLookupTime = timer.elapsed();
+        qDebug() << "Resolved" << m_groups.size() << "groups for" << username << "in" << m_groupLookupTime << "ms";
+        return true;
+#endif
+    }
+
+    qint64 UserSession::groupLookupTime() const {
+        return m_groupLookupTime;
+    }
+
+    qint64 UserSession::vtSwitchTime() const {
+        return m_vtSwitchTime;
+    }
+
 }
@@ -25,6 +25,12 @@
 #include <QtCore/QObject>
 #include <QtCore/QProcess>
 #include <QtCore/QTemporaryFile>
+#include <QtCore/QVector>
+
+#include <pwd.h>
+#include <sys/types.h>
+
+class QSocketNotifier;
 
 namespace SDDM {
     class HelperApp;
@@ -51,6 +57,24 @@ namespace SDDM {
         */
         qint64 cachedProcessId();
 
+        /*!
+         \brief Looks up the supplementary groups of the session's user
+         Meant to be called once PAM established the credentials, the
+         result is kept and used for the session process.
+        */
+        bool resolveGroups();
+
+        /*!
+         \brief Time resolveGroups() took in milliseconds, -1 if it didn't run
+        */
+        qint64 groupLookupTime() const;
+
+        /*!
+         \brief Time the switch to the session's VT took in milliseconds,
+         -1 if there was none or it failed
+        */
+        qint64 vtSwitchTime() const;
+
 
     Q_SIGNALS:
         void finished(int exitCode);
@@ -61,7 +85,41 @@ namespace SDDM {
 #endif
 
     private:
+        // Steps of the child setup that can fail, reported back through a pipe
+        enum ChildStep {
+            Setsid,
+            TakeTty,
+            EnterNamespace,
+            SetUserContext,
+            SetGid,
+            SetGroups,
+            SetUid,
+            ChangeDir,
+            OpenSessionLog,
+            RedirectStdout,
+        };
+
+        // Everything the child needs, prepared before forking so that it
+        // only has to make a few syscalls between fork and exec
+        struct ChildSetup {
+            bool ownsTty { false };
+            int vtNumber { 0 };
+            QByteArray ttyPath;
+            QVector<int> namespaceFds;
+            QStringList namespaces;
+            struct passwd pw { };
+            QByteArray pwBuffer;
+            QVector<gid_t> groups;
+            QByteArrayList logDirs;
+            QByteArray sessionLog;
+            int errorPipe { -1 };
+        };
+
         void setup();
+        bool prepareChild();
+        void releaseChild();
+        void readChildErrors();
+        void childFailed(ChildStep step, int exitCode, bool fatal = true) const;
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
         // Don't call it directly, it will be invoked by the child process only
@@ -72,6 +130,17 @@ namespace SDDM {
         QTemporaryFile m_xauthFile;
         QString m_displayServerCmd;
 
+        ChildSetup m_child;
+
+        // supplementary groups of m_groupsUser, see resolveGroups()
+        QByteArray m_groupsUser;
+        QVector<gid_t> m_groups;
+        qint64 m_groupLookupTime = -1;
+        qint64 m_vtSwitchTime = -1;
+
+        int m_childErrorFd = -1;
+        QSocketNotifier *m_childErrorNotifier = nullptr;
+
         /*!
          Needed for getting the PID of a finished UserSession and calling HelperApp::utmpLogout
         */
@@ -0,0 +1,148 @@
+/*
+ * Mock authentication backend
+ * Copyright (C) 2026 SDDM contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MockBackend.h"
+#include "HelperApp.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QThread>
+
+namespace SDDM {
+    static AuthPrompt::Type promptType(const QString &name) {
+        if (name == QLatin1String("user"))
+            return AuthPrompt::LOGIN_USER;
+        if (name == QLatin1String("password"))
+            return AuthPrompt::LOGIN_PASSWORD;
+        if (name == QLatin1String("current"))
+            return AuthPrompt::CHANGE_CURRENT;
+        if (name == QLatin1String("new"))
+            return AuthPrompt::CHANGE_NEW;
+        if (name == QLatin1String("repeat"))
+            return AuthPrompt::CHANGE_REPEAT;
+        return AuthPrompt::UNKNOWN;
+    }
+
+    static QString promptMessage(AuthPrompt::Type type) {
+        switch (type) {
+            case AuthPrompt::LOGIN_USER:
+                return QStringLiteral("login:");
+            case AuthPrompt::LOGIN_PASSWORD:
+                return QStringLiteral("Password: ");
+            case AuthPrompt::CHANGE_CURRENT:
+                return QStringLiteral("Current password: ");
+            case AuthPrompt::CHANGE_NEW:
+                return QStringLiteral("New password: ");
+            case AuthPrompt::CHANGE_REPEAT:
+                return QStringLiteral("Retype new password: ");
+            default:
+                return QString();
+        }
+    }
+
+    MockBackend::MockBackend(HelperApp *parent, const QString &options)
+            : Backend(parent) {
+        QString prompts = QStringLiteral("password");
+
+        const QStringList list = options.split(QLatin1Char(','), Qt::SkipEmptyParts);
+        for (const QString &option : list) {
+            const QString key = option.section(QLatin1Char('='), 0, 0);
+            const QString value = option.section(QLatin1Char('='), 1);
+            if (key == QLatin1String("prompts"))
+                prompts = value;
+            else if (key == QLatin1String("password"))
+                m_password = value.toUtf8();
+            else if (key == QLatin1String("latency"))
+                m_latency = value.toInt();
+            else if (key == QLatin1String("session-latency"))
+                m_sessionLatency = value.toInt();
+            else
+                qWarning() << "[Mock] Unknown option" << key;
+        }
+
+        const QStringList requests = prompts.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+        for (const QString &request : requests) {
+            QList<AuthPrompt::Type> types;
+            const QStringList names = request.split(QLatin1Char('+'), Qt::SkipEmptyParts);
+            for (const QString &name : names)
+                types << promptType(name);
+            m_requests << types;
+        }
+    }
+
+    bool MockBackend::needsRoot() const {
+        return false;
+    }
+
+    bool MockBackend::start(const QString &user) {
+        m_user = user;
+
+        bool asksUser = false;
+        for (const auto &types : qAsConst(m_requests))
+            asksUser = asksUser || types.contains(AuthPrompt::LOGIN_USER);
+
+        if (m_user.isEmpty() && !asksUser) {
+            m_app->error(QStringLiteral("No user given"), Auth::ERROR_INTERNAL);
+            return false;
+        }
+        return true;
+    }
+
+    bool MockBackend::authenticate() {
+        bool success = true;
+
+        // the greeter and autologin are let in without a conversation, as with PAM
+        if (!m_autologin && !m_greeter) {
+            for (const auto &types : qAsConst(m_requests)) {
+                QList<Prompt> prompts;
+                for (AuthPrompt::Type type : types)
+                    prompts << Prompt(type, promptMessage(type), type != AuthPrompt::LOGIN_USER);
+
+                Request response = m_app->request(Request(prompts));
+                if (response.prompts.length() != prompts.length()) {
+                    success = false;
+                    continue;
+                }
+
+                for (const Prompt &prompt : qAsConst(response.prompts)) {
+                    if (prompt.type == AuthPrompt::LOGIN_USER)
+                        m_user = QString::fromUtf8(prompt.response);
+                    else if ((prompt.type == AuthPrompt::LOGIN_PASSWORD || prompt.type == AuthPrompt::CHANGE_CURRENT)
+                             && !m_password.isNull() && prompt.response != m_password)
+                        success = false;
+                }
+            }
+        }
+
+        QThread::msleep(m_latency);
+
+        if (!success)
+            m_app->error(QStringLiteral("Authentication failure"), Auth::ERROR_AUTHENTICATION);
+        return success;
+    }
+
+    bool MockBackend::openSession() {
+        QThread::msleep(m_sessionLatency);
+        return Backend::openSession();
+    }
+
+    QString MockBackend::userName() {
+        return m_user;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Mock authentication backend
+ * Copyright (C) 2026 SDDM contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#if !defined(MOCKBACKEND_H)
+#define MOCKBACKEND_H
+
+#include "AuthMessages.h"
+#include "../Backend.h"
+
+#include <QtCore/QObject>
+
+namespace SDDM {
+    /**
+     * Deterministic stand-in for PAM, only built with ENABLE_MOCK_AUTH.
+     *
+     * Configured with comma separated key=value options:
+     *   prompts=password          requests to send, separated by '/', the
+     *                             prompts of a request by '+' (user,
+     *                             password, current, new, repeat)
+     *   password=secret           accept only this password, any if unset
+     *   latency=0                 milliseconds authentication takes
+     *   session-latency=0         milliseconds opening the session takes
+     */
+    class MockBackend : public Backend
+    {
+        Q_OBJECT
+    public:
+        explicit MockBackend(HelperApp *parent, const QString &options);
+
+        bool needsRoot() const override;
+
+    public slots:
+        bool start(const QString &user = QString()) override;
+        bool authenticate() override;
+        bool openSession() override;
+
+        QString userName() override;
+
+    private:
+        QList<QList<AuthPrompt::Type>> m_requests;
+        QByteArray m_password;
+        int m_latency { 0 };
+        int m_sessionLatency { 0 };
+        QString m_user;
+    };
+}
+
+#endif // MOCKBACKEND_H
@@ -19,15 +19,24 @@
 
 #include <QCoreApplication>
 #include <QFile>
+#include <QFileInfo>
 #include <QStandardPaths>
 
 #include "Configuration.h"
 
+#include "OutputForwarder.h"
+#include "ProcessReaper.h"
 #include "waylandhelper.h"
 #include "waylandsocketwatcher.h"
 #include "VirtualTerminal.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 namespace SDDM {
@@ -41,21 +50,109 @@ WaylandHelper::WaylandHelper(QObject *parent)
 
 bool WaylandHelper::startCompositor(const QString &cmd)
 {
+    QString command = cmd;
+
+    // Socket activation: when the compositor can take a listening socket
+    // the greeter doesn't have to wait for the compositor to create it
+    if (cmd.contains(QLatin1String("%{fd}"))) {
+        if (!createSocket())
+            return false;
+        const QString socketName = QFileInfo(m_socketPath).fileName();
+        command.replace(QLatin1String("%{fd}"), QString::number(m_socketFd));
+        command.replace(QLatin1String("%{socket}"), socketName);
+        m_watcher->setSocketName(socketName);
+
+        // Only the compositor inherits the socket
+        ::fcntl(m_socketFd, F_SETFD, 0);
+    }
+
     m_watcher->start();
-    return startProcess(cmd, &m_serverProcess);
+    const bool started = startProcess(command, &m_serverProcess);
+
+    if (m_socketFd >= 0) {
+        ::close(m_socketFd);
+        m_socketFd = -1;
+    }
+
+    return started;
+}
+
+bool WaylandHelper::createSocket()
+{
+    const QString runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+
+    // Claim a name the same way libwayland does, so that we don't clash
+    // with other compositors running as the same user
+    for (int i = 0; i < 32; ++i) {
+        const QString path = QStringLiteral("%1/wayland-%2").arg(runtimeDir).arg(i);
+        const QByteArray encodedPath = QFile::encodeName(path);
+        const QByteArray lockPath = encodedPath + ".lock";
+
+        const int lockFd = ::open(lockPath.constData(), O_CREAT | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+        if (lockFd < 0)
+            continue;
+        if (::flock(lockFd, LOCK_EX | LOCK_NB) < 0) {
+            ::close(lockFd);
+            continue;
+        }
+
+        struct sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (size_t(encodedPath.size()) >= sizeof(addr.sun_path)) {
+            qWarning("Wayland socket path \"%s\" is too long", encodedPath.constData());
+            ::close(lockFd);
+            return false;
+        }
+        ::memcpy(addr.sun_path, encodedPath.constData(), encodedPath.size());
+
+        // We hold the lock, so anything left there is stale
+        ::unlink(encodedPath.constData());
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0
+                || ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0
+                || ::listen(fd, 128) < 0) {
+            qWarning("Failed to create Wayland socket \"%s\": %s", encodedPath.constData(), strerror(errno));
+            if (fd >= 0)
+                ::close(fd);
+            ::unlink(lockPath.constData());
+            ::close(lockFd);
+            return false;
+        }
+
+        qDebug() << "Created Wayland socket" << path;
+        m_socketPath = path;
+        m_socketFd = fd;
+        m_lockFd = lockFd;
+        return true;
+    }
+
+    qWarning("No free Wayland socket name in \"%s\"", qPrintable(runtimeDir));
+    return false;
+}
+
+void WaylandHelper::removeSocket()
+{
+    if (m_socketPath.isEmpty())
+        return;
+
+    // The compositor was given a bare fd and doesn't know what to clean up
+    const QByteArray encodedPath = QFile::encodeName(m_socketPath);
+    ::unlink(encodedPath.constData());
+    ::unlink((encodedPath + ".lock").constData());
+    if (m_lockFd >= 0)
+        ::close(m_lockFd);
+    m_lockFd = -1;
+    m_socketPath.clear();
 }
 
 void stopProcess(QProcess *process)
 {
     if (process && process->state() != QProcess::NotRunning) {
         qInfo() << "Stopping..." << process->program();
-        process->terminate();
-        if (!process->waitForFinished(5000)) {
-            process->kill();
-            process->waitForFinished(25000);
-        }
-        process->deleteLater();
-        process = nullptr;
+        ProcessReaper::terminate(process, 5000, [process] {
+            process->deleteLater();
+        });
     }
 }
 
@@ -64,6 +161,7 @@ void WaylandHelper::stop()
     m_watcher->stop();
     stopProcess(m_greeterProcess);
     stopProcess(m_serverProcess);
+    removeSocket();
 }
 
 bool WaylandHelper::startProcess(const QString &cmd, QProcess **p)
@@ -71,12 +169,7 @@ bool WaylandHelper::startProcess(const QString &cmd, QProcess **p)
     auto *process = new QProcess(this);
     process->setProcessEnvironment(m_environment);
     process->setInputChannelMode(QProcess::ForwardedInputChannel);
-    connect(process, &QProcess::readyReadStandardError, this, [process] {
-        qWarning() << process->readAllStandardError();
-    });
-    connect(process, &QProcess::readyReadStandardOutput, this, [process] {
-        qInfo() << process->readAllStandardOutput();
-    });
+    new OutputForwarder(process, QStringLiteral("wayland-compositor"));
     qDebug() << "Starting Wayland process" << cmd << m_environment.value(QStringLiteral("USER"));
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             process, [](int exitCode, QProcess::ExitStatus exitStatus) {
@@ -84,6 +177,7 @@ bool WaylandHelper::startProcess(const QString &cmd, QProcess **p)
         if (exitCode != 0 || exitStatus != QProcess::NormalExit)
             QCoreApplication::instance()->quit();
     });
+    ProcessReaper::supervise(process);
 
     auto args = QProcess::splitCommand(cmd);
     const auto program = args.takeFirst();
@@ -109,17 +203,13 @@ void WaylandHelper::startGreeter(const QString &cmd)
     m_greeterProcess = new QProcess(this);
     m_greeterProcess->setProgram(args.takeFirst());
     m_greeterProcess->setArguments(args);
-    connect(m_greeterProcess, &QProcess::readyReadStandardError, this, [this] {
-        qWarning() << m_greeterProcess->readAllStandardError();
-    });
-    connect(m_greeterProcess, &QProcess::readyReadStandardOutput, this, [this] {
-        qInfo() << m_greeterProcess->readAllStandardOutput();
-    });
+    new OutputForwarder(m_greeterProcess, QStringLiteral("wayland-greeter"));
     connect(m_greeterProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             m_greeterProcess, [](int exitCode, QProcess::ExitStatus exitStatus) {
         qDebug() << "wayland greeter finished" << exitCode << exitStatus;
         QCoreApplication::instance()->quit();
     });
+    ProcessReaper::supervise(m_greeterProcess);
     if (m_watcher->status() == WaylandSocketWatcher::Started) {
         m_environment.insert(QStringLiteral("WAYLAND_DISPLAY"), m_watcher->socketName());
         m_greeterProcess->setProcessEnvironment(m_environment);
@@ -43,7 +43,13 @@ private:
     QProcess *m_serverProcess = nullptr;
     QProcess *m_greeterProcess = nullptr;
     WaylandSocketWatcher * const m_watcher;
+    // pre-bound listening socket, see createSocket()
+    QString m_socketPath;
+    int m_socketFd = -1;
+    int m_lockFd = -1;
 
+    bool createSocket();
+    void removeSocket();
     bool startProcess(const QString &cmd, QProcess **p = nullptr);
 };
 
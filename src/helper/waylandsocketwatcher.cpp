@@ -18,10 +18,18 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 ***************************************************************************/
 
-#include <unistd.h>
 #include <QDebug>
+#include <QRegularExpression>
 #include <QStandardPaths>
 
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#endif
+
 #include "waylandsocketwatcher.h"
 
 namespace SDDM {
@@ -31,7 +39,21 @@ WaylandSocketWatcher::WaylandSocketWatcher(QObject *parent )
     , m_runtimeDir(QDir(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)))
 {
     m_runtimeDir.setFilter(QDir::Files | QDir::System);
-    m_runtimeDir.setNameFilters(QStringList() << QLatin1String("wayland-?"));
+    m_runtimeDir.setNameFilters(QStringList() << QLatin1String("wayland-*"));
+
+    // Give the compositor some time to start
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(15000);
+    connect(&m_timer, &QTimer::timeout, this, [this] {
+        // Time is up and a socket was not found
+        qWarning("Wayland socket watcher timed out");
+        fail();
+    });
+}
+
+WaylandSocketWatcher::~WaylandSocketWatcher()
+{
+    release();
 }
 
 WaylandSocketWatcher::Status WaylandSocketWatcher::status() const
@@ -44,51 +66,65 @@ QString WaylandSocketWatcher::socketName() const
     return m_socketName;
 }
 
+void WaylandSocketWatcher::setSocketName(const QString &name)
+{
+    m_expectedName = name;
+}
+
+void WaylandSocketWatcher::setTimeout(int msecs)
+{
+    m_timer.setInterval(msecs);
+}
+
 void WaylandSocketWatcher::start()
 {
-    m_watcher = new QFileSystemWatcher(this);
+    release();
+    m_socketName.clear();
+    m_status = Stopped;
 
-    // Give the compositor some time to start
-    m_timer.setSingleShot(true);
-    m_timer.setInterval(15000);
-    connect(&m_timer, &QTimer::timeout, this, [this] {
-        // Time is up and a socket was not found
-        if (!m_watcher.isNull())
-            m_watcher->deleteLater();
-        qWarning("Wayland socket watcher timed out");
-        m_status = Failed;
-        Q_EMIT failed();
-    });
+    // A pre-created socket doesn't need any watching
+    if (!m_expectedName.isEmpty() && check(m_expectedName))
+        return;
+
+    if (!m_runtimeDir.exists()) {
+        qWarning("Cannot watch directory \"%s\" for Wayland socket",
+                 qPrintable(m_runtimeDir.absolutePath()));
+        fail();
+        return;
+    }
 
-    // Check if the socket exists
+#ifdef Q_OS_LINUX
+    // Only creations are interesting, so we are not woken up for
+    // every other socket or file that comes and goes in the runtime dir
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0
+            || ::inotify_add_watch(m_inotifyFd, QFile::encodeName(m_runtimeDir.absolutePath()).constData(),
+                                   IN_CREATE | IN_MOVED_TO | IN_ONLYDIR) < 0) {
+        qWarning("Cannot watch directory \"%s\" for Wayland socket: %s",
+                 qPrintable(m_runtimeDir.absolutePath()), strerror(errno));
+        fail();
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &WaylandSocketWatcher::readEvents);
+#else
+    m_watcher = new QFileSystemWatcher(this);
     connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
             [this](const QString &path) {
         qDebug() << "Directory" << path << "has changed, checking for Wayland socket";
-
-        m_runtimeDir.refresh();
-        const QFileInfoList fileInfoList = m_runtimeDir.entryInfoList();
-        for (const QFileInfo &fileInfo : fileInfoList) {
-            if (fileInfo.ownerId() == ::getuid()) {
-                qDebug() << "Found Wayland socket" << fileInfo.absoluteFilePath();
-                m_timer.stop();
-                if (!m_watcher.isNull())
-                    m_watcher->deleteLater();
-                m_socketName = fileInfo.fileName();
-                m_status = Started;
-                Q_EMIT started();
-                break;
-            }
-        }
+        scan();
     });
-
-    // Watch for runtime directory changes
-    if (!m_runtimeDir.exists() || !m_watcher->addPath(m_runtimeDir.absolutePath())) {
+    if (!m_watcher->addPath(m_runtimeDir.absolutePath())) {
         qWarning("Cannot watch directory \"%s\" for Wayland socket",
                  qPrintable(m_runtimeDir.absolutePath()));
-        m_watcher->deleteLater();
-        m_status = Failed;
-        Q_EMIT failed();
+        fail();
+        return;
     }
+#endif
+
+    // The socket might have been created before the watch was added
+    if (!m_expectedName.isEmpty() && check(m_expectedName))
+        return;
 
     // Start
     m_timer.start();
@@ -97,11 +133,105 @@ void WaylandSocketWatcher::start()
 void WaylandSocketWatcher::stop()
 {
     m_timer.stop();
+    release();
+    m_status = Stopped;
+    Q_EMIT stopped();
+}
+
+bool WaylandSocketWatcher::matches(const QString &name) const
+{
+    if (!m_expectedName.isEmpty())
+        return name == m_expectedName;
+
+    // Skip the lock files that libwayland creates next to the socket
+    static const QRegularExpression pattern(QStringLiteral("^wayland-[0-9]+$"));
+    return pattern.match(name).hasMatch();
+}
+
+bool WaylandSocketWatcher::check(const QString &name)
+{
+    const QByteArray path = QFile::encodeName(m_runtimeDir.filePath(name));
+    struct stat st;
+    if (::lstat(path.constData(), &st) != 0 || !S_ISSOCK(st.st_mode) || st.st_uid != ::getuid())
+        return false;
+
+    qDebug() << "Found Wayland socket" << m_runtimeDir.filePath(name);
+    m_timer.stop();
+    release();
+    m_socketName = name;
+    m_status = Started;
+    Q_EMIT started();
+    return true;
+}
+
+bool WaylandSocketWatcher::scan()
+{
+    if (!m_expectedName.isEmpty())
+        return check(m_expectedName);
+
+    m_runtimeDir.refresh();
+    const QStringList names = m_runtimeDir.entryList();
+    for (const QString &name : names) {
+        if (matches(name) && check(name))
+            return true;
+    }
+    return false;
+}
+
+void WaylandSocketWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[4096];
+
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+
+        for (const char *ptr = buffer; ptr < buffer + length; ) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            // Events were lost, look at the directory once
+            if (event->mask & IN_Q_OVERFLOW) {
+                if (scan())
+                    return;
+                continue;
+            }
+
+            if (event->len == 0)
+                continue;
+
+            const QString name = QFile::decodeName(event->name);
+            if (matches(name) && check(name))
+                return;
+        }
+    }
+#endif
+}
+
+void WaylandSocketWatcher::release()
+{
+    if (!m_notifier.isNull()) {
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+    }
+    m_notifier.clear();
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
     if (!m_watcher.isNull())
         m_watcher->deleteLater();
     m_watcher.clear();
-    m_status = Stopped;
-    Q_EMIT stopped();
+}
+
+void WaylandSocketWatcher::fail()
+{
+    m_timer.stop();
+    release();
+    m_status = Failed;
+    Q_EMIT failed();
 }
 
 } // namespace SDDM
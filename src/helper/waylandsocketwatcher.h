@@ -23,6 +23,7 @@
 #include <QDir>
 #include <QFileSystemWatcher>
 #include <QPointer>
+#include <QSocketNotifier>
 #include <QTimer>
 
 namespace SDDM {
@@ -39,10 +40,21 @@ public:
     Q_ENUM(Status)
 
     explicit WaylandSocketWatcher(QObject *parent = nullptr);
+    ~WaylandSocketWatcher();
 
     Status status() const;
     QString socketName() const;
 
+    /**
+     * Only accept a socket with this name instead of any "wayland-N".
+     * If the socket already exists when start() is called, e.g. because
+     * it was pre-created and handed to the compositor, the watcher
+     * reports it right away without watching the runtime directory.
+     */
+    void setSocketName(const QString &name);
+
+    void setTimeout(int msecs);
+
     void start();
     void stop();
 
@@ -52,10 +64,22 @@ Q_SIGNALS:
     void failed();
 
 private:
+    bool matches(const QString &name) const;
+    bool check(const QString &name);
+    bool scan();
+    void readEvents();
+    void release();
+    void fail();
+
     Status m_status = Stopped;
     QDir m_runtimeDir;
+    QString m_expectedName;
     QString m_socketName;
     QTimer m_timer;
+    // inotify descriptor, -1 when not watching
+    int m_inotifyFd = -1;
+    QPointer<QSocketNotifier> m_notifier;
+    // fallback for systems without inotify
     QPointer<QFileSystemWatcher> m_watcher;
 };
 
@@ -23,6 +23,8 @@
 
 #include "Configuration.h"
 
+#include "OutputForwarder.h"
+#include "ProcessReaper.h"
 #include "xorguserhelper.h"
 
 #include <fcntl.h>
@@ -69,15 +71,12 @@ void XOrgUserHelper::stop()
 {
     if (m_serverProcess) {
         qInfo("Stopping server...");
-        m_serverProcess->terminate();
-        if (!m_serverProcess->waitForFinished(5000)) {
-            m_serverProcess->kill();
-            m_serverProcess->waitForFinished(25000);
-        }
-        m_serverProcess->deleteLater();
+        QProcess *process = m_serverProcess;
         m_serverProcess = nullptr;
-
-        displayFinished();
+        ProcessReaper::terminate(process, 5000, [this, process] {
+            process->deleteLater();
+            displayFinished();
+        });
     }
 }
 
@@ -93,17 +92,13 @@ bool XOrgUserHelper::startProcess(const QString &cmd,
     auto *process = new QProcess(this);
     process->setProcessEnvironment(env);
     process->setInputChannelMode(QProcess::ForwardedInputChannel);
-    connect(process, &QProcess::readyReadStandardError, this, [process] {
-        qWarning() << process->readAllStandardError();
-    });
-    connect(process, &QProcess::readyReadStandardOutput, this, [process] {
-        qInfo() << process->readAllStandardOutput();
-    });
+    new OutputForwarder(process, QStringLiteral("xorg-user"));
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             process, [](int exitCode, QProcess::ExitStatus exitStatus) {
         if (exitCode != 0 || exitStatus != QProcess::NormalExit)
             QCoreApplication::instance()->quit();
     });
+    ProcessReaper::supervise(process);
 
     process->start(program, args);
     if (!process->waitForStarted(10000)) {
@@ -231,11 +226,8 @@ void XOrgUserHelper::displayFinished()
     auto cmd = mainConfig.X11.DisplayStopCommand.get();
     qInfo("Running display stop script: %s", qPrintable(cmd));
     QProcess *displayStopScript = nullptr;
-    if (startProcess(cmd, sessionEnvironment(), &displayStopScript)) {
-        if (!displayStopScript->waitForFinished(5000))
-            displayStopScript->kill();
-        displayStopScript->deleteLater();
-    }
+    if (startProcess(cmd, sessionEnvironment(), &displayStopScript))
+        ProcessReaper::limit(displayStopScript, 5000);
 }
 
 } // namespace SDDM
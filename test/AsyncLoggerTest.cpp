@@ -0,0 +1,202 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "AsyncLogger.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+
+using namespace SDDM;
+
+class AsyncLoggerTest : public QObject {
+    Q_OBJECT
+private:
+    static QByteArray logged(const std::function<void(AsyncLogger &logger)> &log)
+    {
+        QTemporaryDir dir;
+        if (!dir.isValid())
+            return QByteArray();
+        const QString fileName = dir.filePath(QStringLiteral("sddm.log"));
+        const int fd = open(QFile::encodeName(fileName).constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return QByteArray();
+
+        {
+            AsyncLogger logger(fd);
+            log(logger);
+            logger.flush();
+        }
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // scopes only label anything with the async sink in use
+        qputenv("SDDM_LOG_SINK", "async");
+        QVERIFY(AsyncLogger::isEnabled());
+    }
+
+    void concurrentProducers()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("sddm.log"));
+        const int fd = open(QFile::encodeName(fileName).constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        QVERIFY(fd >= 0);
+
+        // below both the rate limit and the size of the ring
+        const int threadCount = 4;
+        const int messageCount = 100;
+
+        AsyncLogger *logger = new AsyncLogger(fd);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([logger, t] {
+                for (int i = 0; i < messageCount; ++i)
+                    logger->log(QtWarningMsg, QStringLiteral("thread %1 message %2").arg(t).arg(i));
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        logger->flush();
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QList<QByteArray> lines = file.readAll().split('\n');
+        file.close();
+
+        // every message made it, and those of a thread in the order they were logged
+        QVector<int> next(threadCount, 0);
+        int count = 0;
+        for (const QByteArray &line : lines) {
+            if (line.isEmpty())
+                continue;
+            QVERIFY2(line.contains("(WW) thread "), line.constData());
+            QVERIFY2(line.contains("\tpid="), line.constData());
+
+            const QList<QByteArray> words = line.mid(line.indexOf("thread ")).split('\t').first().split(' ');
+            QCOMPARE(words.size(), 4);
+            const int t = words.at(1).toInt();
+            QVERIFY(t >= 0 && t < threadCount);
+            QCOMPARE(words.at(3).toInt(), next[t]);
+            next[t]++;
+            count++;
+        }
+        QCOMPARE(count, threadCount * messageCount);
+
+        delete logger;
+    }
+
+    void fields()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("sddm.log"));
+        const int fd = open(QFile::encodeName(fileName).constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        QVERIFY(fd >= 0);
+
+        {
+            AsyncLogger logger(fd);
+            logger.log(QtCriticalMsg, QStringLiteral("failure"));
+            logger.flush();
+        }
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray contents = file.readAll();
+        QVERIFY2(contents.contains("(EE) failure\tpid="), contents.constData());
+        QVERIFY(contents.endsWith('\n'));
+    }
+
+    void fieldsAtLogTime()
+    {
+        const QList<QByteArray> lines = logged([](AsyncLogger &logger) {
+            logger.updateField(AsyncLogger::Seat, QStringLiteral("seat0"));
+            logger.log(QtWarningMsg, QStringLiteral("first"));
+            logger.updateField(AsyncLogger::Seat, QStringLiteral("seat1"));
+            logger.log(QtWarningMsg, QStringLiteral("second"));
+        }).split('\n');
+
+        // changing the fields doesn't relabel what is still queued
+        QCOMPARE(lines.size(), 3);
+        QVERIFY2(lines.at(0).contains("(WW) first\t") && lines.at(0).contains(" seat=seat0"), lines.at(0).constData());
+        QVERIFY2(lines.at(1).contains("(WW) second\t") && lines.at(1).contains(" seat=seat1"), lines.at(1).constData());
+    }
+
+    void scope()
+    {
+        const QList<QByteArray> lines = logged([](AsyncLogger &logger) {
+            logger.updateField(AsyncLogger::Seat, QStringLiteral("seat0"));
+            {
+                AsyncLogger::Scope seat(QStringLiteral("seat1"), QString());
+                {
+                    AsyncLogger::Scope display(QString(), QStringLiteral(":1"));
+                    logger.log(QtWarningMsg, QStringLiteral("inner"));
+                }
+                logger.log(QtWarningMsg, QStringLiteral("outer"));
+            }
+            logger.log(QtWarningMsg, QStringLiteral("process"));
+        }).split('\n');
+
+        QCOMPARE(lines.size(), 4);
+        QVERIFY2(lines.at(0).contains(" seat=seat1") && lines.at(0).contains(" display=:1"), lines.at(0).constData());
+        QVERIFY2(lines.at(1).contains(" seat=seat1") && !lines.at(1).contains(" display=:1"), lines.at(1).constData());
+        QVERIFY2(lines.at(2).contains(" seat=seat0") && !lines.at(2).contains(" display=:1"), lines.at(2).constData());
+    }
+
+    void longMessages()
+    {
+        const QString ascii(1000, QLatin1Char('x'));
+        const QString umlauts(1000, QChar(0x00e4));
+        const QList<QByteArray> lines = logged([&](AsyncLogger &logger) {
+            logger.log(QtWarningMsg, ascii);
+            logger.log(QtWarningMsg, umlauts);
+        }).split('\n');
+        QCOMPARE(lines.size(), 3);
+
+        for (int i = 0; i < 2; ++i) {
+            const QByteArray &line = lines.at(i);
+            const int start = line.indexOf("(WW) ") + 5;
+            const QByteArray text = line.mid(start, line.indexOf('\t') - start);
+
+            // cut where a character ends and marked as such
+            QVERIFY(text.size() <= 500);
+            QVERIFY(text.size() > 490);
+            QVERIFY(text.endsWith("\xe2\x80\xa6"));
+            QVERIFY(!QString::fromUtf8(text).contains(QChar::ReplacementCharacter));
+        }
+    }
+};
+
+QTEST_MAIN(AsyncLoggerTest);
+
+#include "AsyncLoggerTest.moc"
@@ -0,0 +1,104 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "Auth.h"
+#include "AuthPrompt.h"
+#include "AuthRequest.h"
+
+#include <QElapsedTimer>
+#include <QTest>
+
+using namespace SDDM;
+
+// enough to have the socket server juggle a few hundred helpers at once
+static const int Helpers = 200;
+
+class AuthStressTest : public QObject {
+    Q_OBJECT
+private slots:
+    void concurrentLogins_data()
+    {
+        QTest::addColumn<QString>("options");
+        QTest::addColumn<QByteArray>("password");
+        QTest::addColumn<bool>("success");
+
+        QTest::newRow("password") << QStringLiteral("password=secret") << QByteArray("secret") << true;
+        QTest::newRow("wrong password") << QStringLiteral("password=secret") << QByteArray("wrong") << false;
+        QTest::newRow("user and password") << QStringLiteral("prompts=user+password,password=secret") << QByteArray("secret") << true;
+        QTest::newRow("two requests") << QStringLiteral("prompts=password/password,latency=20") << QByteArray("any") << true;
+    }
+
+    void concurrentLogins()
+    {
+        QFETCH(QString, options);
+        QFETCH(QByteArray, password);
+        QFETCH(bool, success);
+
+        int succeeded = 0;
+        int failed = 0;
+        int finished = 0;
+        QList<Auth *> auths;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < Helpers; ++i) {
+            Auth *auth = new Auth(this);
+            auth->setHelperPath(QStringLiteral(HELPER_PATH));
+            auth->setBackend(QStringLiteral("mock:") + options);
+            auth->setUser(QStringLiteral("user%1").arg(i));
+
+            connect(auth, &Auth::requestChanged, this, [auth, password] {
+                const auto prompts = auth->request()->prompts();
+                for (AuthPrompt *prompt : prompts) {
+                    if (prompt->type() == AuthPrompt::LOGIN_USER)
+                        prompt->setResponse(auth->user().toUtf8());
+                    else
+                        prompt->setResponse(password);
+                }
+                auth->request()->done();
+            });
+            connect(auth, &Auth::authentication, this, [&](const QString &, bool result) {
+                ++(result ? succeeded : failed);
+            });
+            connect(auth, &Auth::finished, this, [&] { ++finished; });
+
+            auths << auth;
+        }
+
+        for (Auth *auth : qAsConst(auths))
+            auth->start();
+
+        QTRY_COMPARE_WITH_TIMEOUT(finished, Helpers, 60000);
+        QCOMPARE(succeeded, success ? Helpers : 0);
+        if (!success)
+            QCOMPARE(failed, Helpers);
+
+        for (Auth *auth : qAsConst(auths))
+            QVERIFY(auth->authenticationLatency() >= 0);
+
+        qDebug() << Helpers << "helpers done in" << timer.elapsed() << "ms";
+        qDeleteAll(auths);
+    }
+};
+
+QTEST_MAIN(AuthStressTest);
+
+#include "AuthStressTest.moc"
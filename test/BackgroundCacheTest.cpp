@@ -0,0 +1,196 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "BackgroundCache.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace SDDM;
+
+class BackgroundCacheTest : public QObject {
+    Q_OBJECT
+private:
+    static bool writeImage(const QString &fileName, const QSize &size)
+    {
+        QImage image(size, QImage::Format_RGB32);
+        image.fill(QColor(Qt::red));
+        return image.save(fileName, "PNG");
+    }
+
+    static bool setModified(const QString &fileName, const QDateTime &modified)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadWrite))
+            return false;
+        return file.setFileTime(modified, QFileDevice::FileModificationTime);
+    }
+
+private slots:
+    void scaled()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+
+        BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+
+        // covers the screen, keeping the aspect ratio
+        QImage image = cache.image(fileName, QSize(100, 100));
+        QCOMPARE(image.size(), QSize(200, 100));
+        QCOMPARE(image.pixelColor(10, 10), QColor(Qt::red));
+
+        // never scaled up
+        image = cache.image(fileName, QSize(800, 800));
+        QCOMPARE(image.size(), QSize(400, 200));
+
+        QCOMPARE(QDir(dir.filePath(QStringLiteral("cache"))).entryList(QDir::Files).size(), 2);
+    }
+
+    void shared()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+
+        BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+        const QImage first = cache.image(fileName, QSize(100, 100));
+        const QImage second = cache.image(fileName, QSize(100, 100));
+        QVERIFY(!first.isNull());
+        QCOMPARE(first.cacheKey(), second.cacheKey());
+    }
+
+    void oneImagePerSource()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+
+        BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+        const QImage first = cache.image(fileName, QSize(100, 100));
+        QCOMPARE(cache.image(fileName, QSize(50, 50)).size(), QSize(100, 50));
+
+        // the other size replaced it in memory
+        const QImage again = cache.image(fileName, QSize(100, 100));
+        QCOMPARE(again.size(), first.size());
+        QVERIFY(again.cacheKey() != first.cacheKey());
+    }
+
+    void staleCopies()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        const QString otherFileName = dir.filePath(QStringLiteral("other.png"));
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+        QVERIFY(writeImage(otherFileName, QSize(400, 200)));
+        const QDir cacheDir(dir.filePath(QStringLiteral("cache")));
+
+        {
+            BackgroundCache cache(cacheDir.path());
+            QVERIFY(!cache.image(fileName, QSize(100, 100)).isNull());
+            QVERIFY(!cache.image(otherFileName, QSize(100, 100)).isNull());
+        }
+        QCOMPARE(cacheDir.entryList(QDir::Files).size(), 2);
+
+        // the screen changed, the copy at the old size goes
+        {
+            BackgroundCache cache(cacheDir.path());
+            QCOMPARE(cache.image(fileName, QSize(50, 50)).size(), QSize(100, 50));
+        }
+        const QStringList files = cacheDir.entryList(QDir::Files);
+        QCOMPARE(files.size(), 2);
+        QCOMPARE(files.filter(QStringLiteral("-100x100.img")).size(), 1);
+        QCOMPARE(files.filter(QStringLiteral("-50x50.img")).size(), 1);
+    }
+
+    void persistent()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        const QDateTime modified = QDateTime::currentDateTime().addSecs(-60);
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+        QVERIFY(setModified(fileName, modified));
+
+        {
+            BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+            QVERIFY(!cache.image(fileName, QSize(100, 100)).isNull());
+        }
+
+        // same size and time, so the scaled copy is used instead of decoding
+        QFile file(fileName);
+        const qint64 size = file.size();
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(QByteArray(int(size), 'x')), size);
+        file.close();
+        QVERIFY(setModified(fileName, modified));
+        {
+            BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+            const QImage image = cache.image(fileName, QSize(100, 100));
+            QCOMPARE(image.size(), QSize(200, 100));
+            QCOMPARE(image.pixelColor(10, 10), QColor(Qt::red));
+        }
+
+        // a new modification time invalidates it
+        QVERIFY(setModified(fileName, modified.addSecs(1)));
+        {
+            BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+            QVERIFY(cache.image(fileName, QSize(100, 100)).isNull());
+        }
+    }
+
+    void unwritableCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("background.png"));
+        QVERIFY(writeImage(fileName, QSize(400, 200)));
+
+        // a file where the directory should be
+        QFile blocker(dir.filePath(QStringLiteral("cache")));
+        QVERIFY(blocker.open(QIODevice::WriteOnly));
+        blocker.close();
+
+        BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+        QCOMPARE(cache.image(fileName, QSize(100, 100)).size(), QSize(200, 100));
+    }
+
+    void missing()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        BackgroundCache cache(dir.filePath(QStringLiteral("cache")));
+        QVERIFY(cache.image(dir.filePath(QStringLiteral("background.png")), QSize(100, 100)).isNull());
+    }
+};
+
+QTEST_GUILESS_MAIN(BackgroundCacheTest);
+
+#include "BackgroundCacheTest.moc"
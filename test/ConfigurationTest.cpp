@@ -244,4 +244,29 @@ void ConfigurationTest::FileChanged()
     QVERIFY(config->Int.get() == 222222);
 }
 
+void ConfigurationTest::AtomicSave()
+{
+    config->String.set(QStringLiteral("a"));
+    config->save();
+    QVERIFY(QFile::exists(CONF_FILE));
+    const QDateTime modified = QFileInfo(CONF_FILE).lastModified();
+
+    // no temporary files must be left behind
+    const auto leftovers = QDir().entryList({CONF_FILE + QStringLiteral(".*")}, QDir::Files);
+    QVERIFY(leftovers.isEmpty());
+
+    // saving again without any change must not touch the file
+    QTest::qWait(100);
+    config->save();
+    QCOMPARE(QFileInfo(CONF_FILE).lastModified(), modified);
+
+    // but a changed value is written
+    config->String.set(QStringLiteral("b"));
+    config->save();
+    QVERIFY(QFileInfo(CONF_FILE).lastModified() != modified);
+    delete config;
+    config = new TestConfig;
+    QCOMPARE(config->String.get(), QStringLiteral("b"));
+}
+
 #include "moc_ConfigurationTest.cpp"
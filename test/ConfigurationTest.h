@@ -95,6 +95,7 @@ private slots:
     void RightOnInit();
     void RightOnInitDir();
     void FileChanged();
+    void AtomicSave();
 
 private:
     TestConfig *config;
@@ -0,0 +1,163 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "LastSessions.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <sys/stat.h>
+
+using namespace SDDM;
+
+class LastSessionsTest : public QObject {
+    Q_OBJECT
+private:
+    static QByteArray contents(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    static bool write(const QString &fileName, const QByteArray &data)
+    {
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+    }
+
+    static int mode(const QString &fileName)
+    {
+        struct stat st;
+        if (::stat(QFile::encodeName(fileName).constData(), &st) != 0)
+            return -1;
+        return int(st.st_mode & 07777);
+    }
+
+private slots:
+    void lookupAfterAppend()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("last-sessions"));
+
+        {
+            LastSessions sessions(path);
+            QVERIFY(sessions.session(1000).isEmpty());
+            sessions.setSession(1000, QStringLiteral("plasma.desktop"));
+            sessions.setSession(1001, QStringLiteral("gnome.desktop"));
+            sessions.setSession(1000, QStringLiteral("plasmax11.desktop"));
+            QCOMPARE(sessions.session(1000), QStringLiteral("plasmax11.desktop"));
+        }
+
+        // only appended, the last line of a uid wins
+        QCOMPARE(contents(path), QByteArray("1000\tplasma.desktop\n1001\tgnome.desktop\n1000\tplasmax11.desktop\n"));
+
+        LastSessions sessions(path);
+        QCOMPARE(sessions.session(1000), QStringLiteral("plasmax11.desktop"));
+        QCOMPARE(sessions.session(1001), QStringLiteral("gnome.desktop"));
+        QVERIFY(sessions.session(1002).isEmpty());
+
+        // an empty session forgets the user
+        sessions.setSession(1001, QString());
+        QVERIFY(LastSessions(path).session(1001).isEmpty());
+    }
+
+    void unchanged()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("last-sessions"));
+
+        LastSessions sessions(path);
+        sessions.setSession(1000, QStringLiteral("plasma.desktop"));
+        sessions.setSession(1000, QStringLiteral("plasma.desktop"));
+        QCOMPARE(contents(path), QByteArray("1000\tplasma.desktop\n"));
+    }
+
+    void privateFile()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("last-sessions"));
+
+        LastSessions sessions(path);
+        sessions.setSession(1000, QStringLiteral("plasma.desktop"));
+        QCOMPARE(mode(path), 0600);
+
+        // and it stays that way when the file is rewritten
+        for (int i = 0; i < 100; ++i)
+            sessions.setSession(1000, QStringLiteral("session%1.desktop").arg(i));
+        QVERIFY(contents(path).split('\n').size() < 64);
+        QCOMPARE(mode(path), 0600);
+    }
+
+    void compaction()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("last-sessions"));
+
+        {
+            LastSessions sessions(path);
+            sessions.setSession(1001, QStringLiteral("gnome.desktop"));
+            for (int i = 0; i < 100; ++i)
+                sessions.setSession(1000, QStringLiteral("session%1.desktop").arg(i));
+        }
+
+        const QList<QByteArray> lines = contents(path).split('\n');
+        QVERIFY(lines.size() < 64);
+
+        LastSessions sessions(path);
+        QCOMPARE(sessions.session(1000), QStringLiteral("session99.desktop"));
+        QCOMPARE(sessions.session(1001), QStringLiteral("gnome.desktop"));
+    }
+
+    void truncatedLine()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("last-sessions"));
+        QVERIFY(write(path, "1000\tplasma.desktop\n1001\tgno"));
+
+        {
+            LastSessions sessions(path);
+            QCOMPARE(sessions.session(1000), QStringLiteral("plasma.desktop"));
+            QVERIFY(sessions.session(1001).isEmpty());
+
+            // rewrites the file instead of appending to the cut off line
+            sessions.setSession(1002, QStringLiteral("sway.desktop"));
+        }
+
+        QVERIFY(contents(path).endsWith('\n'));
+        QVERIFY(!contents(path).contains("gno"));
+
+        LastSessions sessions(path);
+        QCOMPARE(sessions.session(1000), QStringLiteral("plasma.desktop"));
+        QVERIFY(sessions.session(1001).isEmpty());
+        QCOMPARE(sessions.session(1002), QStringLiteral("sway.desktop"));
+    }
+};
+
+QTEST_MAIN(LastSessionsTest);
+
+#include "LastSessionsTest.moc"
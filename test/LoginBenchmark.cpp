@@ -0,0 +1,318 @@
+/*
+ * Login pipeline benchmark
+ * Copyright (C) 2026 SDDM contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/*
+ * Runs the daemon in test mode and logs in and out N times.
+ *
+ * The same binary plays two roles: started by hand it is the driver, which
+ * launches the daemon and samples it after every cycle. The daemon starts
+ * it again in place of the greeter (SDDM_TEST_GREETER), and that instance
+ * logs in once, appends the result to a file and quits. The session it
+ * picks exits right away, so the display is restarted and the next greeter
+ * starts the next cycle.
+ *
+ * With a helper built with ENABLE_MOCK_AUTH, --backend mock[:options] keeps
+ * PAM out of the measurement.
+ */
+
+#include "Messages.h"
+#include "Session.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTextStream>
+#include <QtCore/QTimer>
+#include <QtNetwork/QLocalSocket>
+
+#include <algorithm>
+
+using namespace SDDM;
+
+static const char *ResultsVariable = "SDDM_BENCH_RESULTS";
+static const char *UserVariable = "SDDM_BENCH_USER";
+static const char *PasswordVariable = "SDDM_BENCH_PASSWORD";
+static const char *SessionVariable = "SDDM_BENCH_SESSION";
+
+static void appendResult(bool success, qint64 msecs) {
+    QFile file(qEnvironmentVariable(ResultsVariable));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return;
+    file.write(QStringLiteral("%1 %2\n").arg(success ? QStringLiteral("ok") : QStringLiteral("fail")).arg(msecs).toLatin1());
+}
+
+/*
+ * Greeter role: connect, wait for the bootstrap, log in, report.
+ */
+static int runGreeter(QCoreApplication &app, const QString &socketPath) {
+    QLocalSocket socket;
+    QElapsedTimer timer;
+    bool reported = false;
+
+    auto report = [&](bool success) {
+        if (reported)
+            return;
+        reported = true;
+        appendResult(success, timer.isValid() ? timer.elapsed() : -1);
+        app.quit();
+    };
+
+    QObject::connect(&socket, &QLocalSocket::connected, &app, [&] {
+        QDataStream output(&socket);
+        output << quint32(GreeterMessages::Connect);
+    });
+    QObject::connect(&socket, &QLocalSocket::disconnected, &app, [&] { report(false); });
+    QObject::connect(&socket, &QLocalSocket::errorOccurred, &app, [&] { report(false); });
+    QObject::connect(&socket, &QLocalSocket::readyRead, &app, [&] {
+        QDataStream input(&socket);
+
+        while (input.device()->bytesAvailable()) {
+            quint32 message;
+            input >> message;
+
+            switch (DaemonMessages(message)) {
+                case DaemonMessages::Bootstrap: {
+                    QString hostName, lastUser, lastSession;
+                    quint32 capabilities, numLock;
+                    input >> hostName >> capabilities >> lastUser >> lastSession >> numLock;
+
+                    // only now, like a real greeter would
+                    QDataStream output(&socket);
+                    timer.start();
+                    output << quint32(GreeterMessages::Login)
+                           << qEnvironmentVariable(UserVariable)
+                           << qEnvironmentVariable(PasswordVariable)
+                           << quint32(Session::X11Session)
+                           << qEnvironmentVariable(SessionVariable);
+                }
+                break;
+                case DaemonMessages::HostName:
+                case DaemonMessages::InformationMessage: {
+                    QString text;
+                    input >> text;
+                }
+                break;
+                case DaemonMessages::Capabilities: {
+                    quint32 capabilities;
+                    input >> capabilities;
+                }
+                break;
+                case DaemonMessages::PowerActionFinished: {
+                    quint32 action, success;
+                    QString error;
+                    input >> action >> success >> error;
+                }
+                break;
+                case DaemonMessages::LoginSucceeded:
+                    report(true);
+                    return;
+                case DaemonMessages::LoginFailed:
+                    report(false);
+                    return;
+                default:
+                    qWarning() << "Unknown message" << message;
+                    report(false);
+                    return;
+            }
+        }
+    });
+
+    socket.connectToServer(socketPath);
+    return app.exec();
+}
+
+/*
+ * Driver role: run the daemon and sample it after every cycle.
+ */
+struct Sample {
+    qint64 rss { 0 };
+    int fds { 0 };
+};
+
+static Sample sample(qint64 pid) {
+    Sample result;
+
+    QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+    if (status.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> lines = status.readAll().split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.startsWith("VmRSS:"))
+                result.rss = line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+
+    result.fds = QDir(QStringLiteral("/proc/%1/fd").arg(pid)).entryList(QDir::Files | QDir::System).count();
+    return result;
+}
+
+static qint64 percentile(QVector<qint64> values, int percent) {
+    if (values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    const int rank = qMax(1, (values.size() * percent + 99) / 100);
+    return values.at(rank - 1);
+}
+
+static int runDriver(QCoreApplication &app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures the login pipeline of the daemon in test mode"));
+    parser.addHelpOption();
+    QCommandLineOption daemonOption(QStringLiteral("daemon"), QStringLiteral("Daemon binary."), QStringLiteral("path"), QStringLiteral("sddm"));
+    QCommandLineOption cyclesOption(QStringLiteral("cycles"), QStringLiteral("Number of login/logout cycles."), QStringLiteral("n"), QStringLiteral("20"));
+    QCommandLineOption userOption(QStringLiteral("user"), QStringLiteral("User to log in."), QStringLiteral("name"));
+    QCommandLineOption passwordOption(QStringLiteral("password"), QStringLiteral("Password of the user."), QStringLiteral("password"));
+    QCommandLineOption sessionOption(QStringLiteral("session"), QStringLiteral("Session file, one that quits right away by default."), QStringLiteral("path"));
+    QCommandLineOption timeoutOption(QStringLiteral("timeout"), QStringLiteral("Seconds to wait for a single cycle."), QStringLiteral("s"), QStringLiteral("60"));
+    QCommandLineOption backendOption(QStringLiteral("backend"), QStringLiteral("Authentication backend of the helper, e.g. mock:latency=50."), QStringLiteral("name[:options]"));
+    QCommandLineOption logOption(QStringLiteral("log"), QStringLiteral("Keep the daemon's output in this file."), QStringLiteral("path"));
+    parser.addOptions({ daemonOption, cyclesOption, userOption, passwordOption, sessionOption, timeoutOption, backendOption, logOption });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const int cycles = parser.value(cyclesOption).toInt();
+    const qint64 timeout = parser.value(timeoutOption).toLongLong() * 1000;
+    if (cycles < 1 || !parser.isSet(userOption)) {
+        err << "A user and at least one cycle are needed\n";
+        return 1;
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        err << "Failed to create a temporary directory\n";
+        return 1;
+    }
+
+    QString sessionFile = parser.value(sessionOption);
+    if (sessionFile.isEmpty()) {
+        sessionFile = dir.filePath(QStringLiteral("benchmark.desktop"));
+        QFile file(sessionFile);
+        if (!file.open(QIODevice::WriteOnly)) {
+            err << "Failed to write " << sessionFile << "\n";
+            return 1;
+        }
+        file.write("[Desktop Entry]\nType=XSession\nName=Benchmark\nExec=/bin/true\n");
+    }
+
+    const QString resultsFile = dir.filePath(QStringLiteral("results"));
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("SDDM_TEST_GREETER"), QCoreApplication::applicationFilePath());
+    if (parser.isSet(backendOption))
+        env.insert(QStringLiteral("SDDM_AUTH_BACKEND"), parser.value(backendOption));
+    env.insert(QString::fromLatin1(ResultsVariable), resultsFile);
+    env.insert(QString::fromLatin1(UserVariable), parser.value(userOption));
+    env.insert(QString::fromLatin1(PasswordVariable), parser.value(passwordOption));
+    env.insert(QString::fromLatin1(SessionVariable), QFileInfo(sessionFile).absoluteFilePath());
+
+    QProcess daemon;
+    daemon.setProcessEnvironment(env);
+    daemon.setStandardOutputFile(QProcess::nullDevice());
+    daemon.setStandardErrorFile(parser.isSet(logOption) ? parser.value(logOption) : QProcess::nullDevice());
+    daemon.start(parser.value(daemonOption), { QStringLiteral("--test-mode") });
+    if (!daemon.waitForStarted()) {
+        err << "Failed to start " << parser.value(daemonOption) << ": " << daemon.errorString() << "\n";
+        return 1;
+    }
+
+    QVector<qint64> latencies;
+    QVector<Sample> samples;
+    int failures = 0;
+    int exitCode = 0;
+    qint64 offset = 0;
+    QElapsedTimer sinceLast;
+    sinceLast.start();
+
+    auto finish = [&](int code) {
+        exitCode = code;
+        daemon.terminate();
+        if (!daemon.waitForFinished(10000))
+            daemon.kill();
+        app.quit();
+    };
+
+    QObject::connect(&daemon, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), &app, [&] {
+        if (latencies.size() + failures < cycles) {
+            err << "The daemon quit after " << latencies.size() + failures << " cycles\n";
+            exitCode = 1;
+            app.quit();
+        }
+    });
+
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &app, [&] {
+        QFile file(resultsFile);
+        if (file.open(QIODevice::ReadOnly) && file.size() > offset) {
+            file.seek(offset);
+            while (file.canReadLine()) {
+                const QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+                if (fields.first() == "ok")
+                    latencies << fields.last().toLongLong();
+                else
+                    ++failures;
+                samples << sample(daemon.processId());
+                sinceLast.restart();
+            }
+            offset = file.pos();
+        }
+
+        if (latencies.size() + failures >= cycles)
+            finish(0);
+        else if (sinceLast.elapsed() > timeout) {
+            err << "Cycle " << latencies.size() + failures + 1 << " timed out\n";
+            finish(1);
+        }
+    });
+    poll.start(100);
+
+    app.exec();
+    poll.stop();
+
+    out << "cycles: " << latencies.size() + failures << " (" << failures << " failed)\n";
+    out << "login latency: p50 " << percentile(latencies, 50) << " ms, p95 " << percentile(latencies, 95)
+        << " ms, p99 " << percentile(latencies, 99) << " ms\n";
+    if (samples.size() > 1) {
+        // the first cycle warms up caches, compare against it rather than the idle daemon
+        const Sample &first = samples.first();
+        const Sample &last = samples.last();
+        out << "memory: " << first.rss << " kB -> " << last.rss << " kB, "
+            << double(last.rss - first.rss) / (samples.size() - 1) << " kB per cycle\n";
+        out << "fds: " << first.fds << " -> " << last.fds << ", " << last.fds - first.fds << " leaked\n";
+    }
+
+    return exitCode ? exitCode : (failures ? 2 : 0);
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    // started by the daemon in place of the greeter
+    const QStringList arguments = app.arguments();
+    const int socketIndex = arguments.indexOf(QStringLiteral("--socket"));
+    if (socketIndex != -1 && socketIndex + 1 < arguments.size())
+        return runGreeter(app, arguments.at(socketIndex + 1));
+
+    return runDriver(app);
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "Metrics.h"
+
+#include <QTest>
+
+using namespace SDDM;
+
+class MetricsTest : public QObject {
+    Q_OBJECT
+private slots:
+    void countersPerSeat()
+    {
+        Metrics metrics;
+        metrics.count(Metrics::AuthFailures, QStringLiteral("seat0"));
+        metrics.count(Metrics::AuthFailures, QStringLiteral("seat0"));
+        metrics.count(Metrics::AuthFailures, QStringLiteral("seat1"));
+
+        QCOMPARE(metrics.counter(Metrics::AuthFailures, QStringLiteral("seat0")), quint64(2));
+        QCOMPARE(metrics.counter(Metrics::AuthFailures, QStringLiteral("seat1")), quint64(1));
+        QCOMPARE(metrics.total(Metrics::AuthFailures), quint64(3));
+        QCOMPARE(metrics.total(Metrics::HelperCrashes), quint64(0));
+
+        const QVariantMap values = metrics.GetMetrics();
+        QCOMPARE(values.value(QStringLiteral("auth_failures")).toULongLong(), quint64(3));
+        QCOMPARE(values.value(QStringLiteral("auth_failures.seat0")).toULongLong(), quint64(2));
+        QCOMPARE(values.value(QStringLiteral("auth_failures.seat1")).toULongLong(), quint64(1));
+        QCOMPARE(values.value(QStringLiteral("helper_crashes")).toULongLong(), quint64(0));
+    }
+
+    void scrape()
+    {
+        Metrics metrics;
+        metrics.count(Metrics::AuthFailures, QStringLiteral("seat0"));
+        metrics.count(Metrics::AuthFailures, QStringLiteral("seat1"));
+
+        const QStringList lines = metrics.Scrape().split(QLatin1Char('\n'));
+        QVERIFY(lines.contains(QStringLiteral("sddm_auth_failures_total{seat=\"seat0\"} 1")));
+        QVERIFY(lines.contains(QStringLiteral("sddm_auth_failures_total{seat=\"seat1\"} 1")));
+        // no unlabeled series next to the ones of the seats
+        QVERIFY(!lines.contains(QStringLiteral("sddm_auth_failures_total 0")));
+
+        // nothing counted yet, but the counter is there
+        QVERIFY(lines.contains(QStringLiteral("sddm_helper_crashes_total 0")));
+    }
+
+    void histograms()
+    {
+        Metrics metrics;
+        for (int i = 0; i < 99; ++i)
+            metrics.observe(Metrics::LoginLatency, 20);
+        metrics.observe(Metrics::LoginLatency, 4000);
+
+        QCOMPARE(metrics.percentile(Metrics::LoginLatency, 50), qint64(25));
+        QCOMPARE(metrics.percentile(Metrics::LoginLatency, 99), qint64(25));
+        QCOMPARE(metrics.percentile(Metrics::LoginLatency, 100), qint64(4000));
+        QCOMPARE(metrics.percentile(Metrics::PamTime, 50), qint64(0));
+
+        const QVariantMap values = metrics.GetMetrics();
+        QCOMPARE(values.value(QStringLiteral("login_latency.count")).toULongLong(), quint64(100));
+        QCOMPARE(values.value(QStringLiteral("login_latency.max_ms")).toLongLong(), qint64(4000));
+    }
+};
+
+QTEST_MAIN(MetricsTest);
+
+#include "MetricsTest.moc"
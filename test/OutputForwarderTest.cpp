@@ -0,0 +1,131 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "OutputForwarder.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace SDDM;
+
+class OutputForwarderTest : public QObject {
+    Q_OBJECT
+private:
+    // runs the awk program and forwards its output into fileName
+    static quint64 forward(const QString &program, const QString &fileName, qint64 maxSize = 1024 * 1024)
+    {
+        QProcess process;
+        OutputForwarder *forwarder = new OutputForwarder(&process, QStringLiteral("test"));
+        forwarder->setLogFile(fileName, maxSize);
+
+        process.start(QStringLiteral("awk"), { QStringLiteral("BEGIN { %1 }").arg(program) });
+        if (!process.waitForFinished())
+            return quint64(-1);
+        return forwarder->droppedLines();
+    }
+
+    static QList<QByteArray> lines(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return { };
+        QList<QByteArray> lines = file.readAll().split('\n');
+        if (!lines.isEmpty() && lines.last().isEmpty())
+            lines.removeLast();
+        return lines;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        if (QStandardPaths::findExecutable(QStringLiteral("awk")).isEmpty())
+            QSKIP("awk is needed to produce the output");
+    }
+
+    void lineRateLimit()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("test.log"));
+
+        QCOMPARE(forward(QStringLiteral("for (i = 0; i < 1000; i++) print i"), fileName), quint64(800));
+
+        // the first 200 of the second, then how many didn't make it
+        const QList<QByteArray> output = lines(fileName);
+        QCOMPARE(output.size(), 201);
+        QCOMPARE(output.first(), QByteArray("0"));
+        QCOMPARE(output.at(199), QByteArray("199"));
+        QCOMPARE(output.last(), QByteArray("800 lines dropped, 800 in total"));
+    }
+
+    void byteRateLimit()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("test.log"));
+
+        // 64 KiB fit 65 of these
+        QCOMPARE(forward(QStringLiteral("s = sprintf(\"%1000s\", \"\"); for (i = 0; i < 100; i++) print s"), fileName), quint64(35));
+
+        const QList<QByteArray> output = lines(fileName);
+        QCOMPARE(output.size(), 66);
+        QCOMPARE(output.first().size(), 1000);
+        QCOMPARE(output.last(), QByteArray("35 lines dropped, 35 in total"));
+    }
+
+    void longLines()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("test.log"));
+
+        QCOMPARE(forward(QStringLiteral("for (i = 0; i < 1000; i++) s = s \"xxxxxxxxxx\"; print s; print \"short\""), fileName), quint64(0));
+
+        const QList<QByteArray> output = lines(fileName);
+        QVERIFY(output.size() >= 2);
+        QCOMPARE(output.first().size(), 4096);
+        for (const QByteArray &line : output)
+            QVERIFY(line.size() <= 4096);
+        QCOMPARE(output.last(), QByteArray("short"));
+    }
+
+    void rotation()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString fileName = dir.filePath(QStringLiteral("test.log"));
+
+        QCOMPARE(forward(QStringLiteral("s = sprintf(\"%99s\", \"\"); for (i = 0; i < 30; i++) print s"), fileName, 1000), quint64(0));
+
+        // a single old copy is kept, neither grows past the limit
+        QVERIFY(QFile::exists(fileName + QStringLiteral(".1")));
+        QVERIFY(!QFile::exists(fileName + QStringLiteral(".2")));
+        QVERIFY(QFileInfo(fileName).size() <= 1000);
+        QVERIFY(QFileInfo(fileName + QStringLiteral(".1")).size() <= 1000);
+    }
+};
+
+QTEST_MAIN(OutputForwarderTest);
+
+#include "OutputForwarderTest.moc"
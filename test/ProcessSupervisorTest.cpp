@@ -0,0 +1,172 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+#include "ProcessReaper.h"
+#include "ProcessSupervisor.h"
+
+#include <QEventLoop>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QTest>
+#include <QTimer>
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace SDDM;
+
+class ProcessSupervisorTest : public QObject {
+    Q_OBJECT
+private:
+    static const int Children = 200;
+
+    // a child that exits with exitCode right away or waits to be killed
+    static pid_t spawn(int exitCode = -1)
+    {
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            if (exitCode >= 0)
+                ::_exit(exitCode);
+            for (;;)
+                ::pause();
+        }
+        return pid;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        if (!ProcessSupervisor::isSupported())
+            QSKIP("pidfd is not supported by this kernel");
+    }
+
+    void killForkedChildren()
+    {
+        QList<ProcessSupervisor *> supervisors;
+        int exited = 0;
+        for (int i = 0; i < Children; ++i) {
+            const pid_t pid = spawn();
+            QVERIFY(pid > 0);
+            auto *supervisor = new ProcessSupervisor(this);
+            supervisors << supervisor;
+            connect(supervisor, &ProcessSupervisor::exited, this, [&exited] { ++exited; });
+            QVERIFY(supervisor->attach(pid));
+            QVERIFY(supervisor->isRunning());
+            QVERIFY(supervisor->sendSignal(SIGKILL));
+        }
+
+        QTRY_COMPARE_WITH_TIMEOUT(exited, Children, 10000);
+        for (ProcessSupervisor *supervisor : qAsConst(supervisors)) {
+            QVERIFY(!supervisor->isRunning());
+            QVERIFY(WIFSIGNALED(supervisor->status()));
+            QCOMPARE(WTERMSIG(supervisor->status()), SIGKILL);
+            // a reaped PID may be reused, nothing must be sent to it
+            QVERIFY(!supervisor->sendSignal(SIGTERM));
+        }
+        qDeleteAll(supervisors);
+
+        // all of them were reaped
+        QCOMPARE(::waitpid(-1, nullptr, WNOHANG), -1);
+        QCOMPARE(errno, ECHILD);
+    }
+
+    void exitStatus()
+    {
+        ProcessSupervisor supervisor;
+        QVERIFY(supervisor.attach(spawn(7)));
+        QTRY_VERIFY(!supervisor.isRunning());
+        QVERIFY(WIFEXITED(supervisor.status()));
+        QCOMPARE(WEXITSTATUS(supervisor.status()), 7);
+    }
+
+    void exitedBeforeAttach()
+    {
+        const pid_t pid = spawn(3);
+        QVERIFY(pid > 0);
+
+        // wait for it to exit but leave the zombie around
+        siginfo_t info;
+        QCOMPARE(::waitid(P_PID, pid, &info, WEXITED | WNOWAIT), 0);
+
+        ProcessSupervisor supervisor;
+        QSignalSpy spy(&supervisor, &ProcessSupervisor::exited);
+        QVERIFY(supervisor.attach(pid));
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(WEXITSTATUS(supervisor.status()), 3);
+    }
+
+    void terminateQProcesses()
+    {
+        QList<QProcess *> processes;
+        int exited = 0;
+        for (int i = 0; i < Children / 4; ++i) {
+            auto *process = new QProcess(this);
+            processes << process;
+            process->start(QStringLiteral("sleep"), { QStringLiteral("60") });
+            QVERIFY(process->waitForStarted());
+
+            auto *supervisor = new ProcessSupervisor(process);
+            connect(supervisor, &ProcessSupervisor::exited, this, [&exited] { ++exited; });
+            QVERIFY(supervisor->attach(process));
+            QVERIFY(supervisor->sendSignal(SIGTERM));
+        }
+
+        QTRY_COMPARE_WITH_TIMEOUT(exited, processes.size(), 10000);
+
+        // QProcess still does the reaping
+        for (QProcess *process : qAsConst(processes)) {
+            QTRY_COMPARE(process->state(), QProcess::NotRunning);
+            QCOMPARE(process->exitStatus(), QProcess::CrashExit);
+        }
+        qDeleteAll(processes);
+    }
+
+    void reaperUsesStartSupervisor()
+    {
+        QProcess process;
+        ProcessSupervisor *supervisor = ProcessReaper::supervise(&process);
+        process.start(QStringLiteral("sleep"), { QStringLiteral("60") });
+        QVERIFY(process.waitForStarted());
+        QCOMPARE(supervisor->pid(), process.processId());
+        QVERIFY(supervisor->isRunning());
+
+        // the reaper only runs asynchronously inside an event loop
+        QEventLoop loop;
+        bool done = false;
+        QTimer::singleShot(0, &loop, [&] {
+            ProcessReaper::terminate(&process, 10000, [&] {
+                done = true;
+                loop.quit();
+            });
+        });
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        QVERIFY(done);
+        QVERIFY(!supervisor->isRunning());
+        QCOMPARE(process.state(), QProcess::NotRunning);
+        QCOMPARE(process.findChildren<ProcessSupervisor *>().size(), 1);
+    }
+};
+
+QTEST_MAIN(ProcessSupervisorTest);
+
+#include "ProcessSupervisorTest.moc"
@@ -0,0 +1,180 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "VirtualTerminalManager.h"
+#include "config.h"
+
+#include <QHash>
+#include <QTest>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace SDDM;
+
+// behaves like the kernel: VT_OPENQRY returns the lowest VT nobody has open
+class FakeVirtualTerminalManager : public VirtualTerminalManager {
+public:
+    QSet<int> sessions;
+    int active { 1 };
+    mutable QHash<int, int> openFds;
+
+    bool isOpen(int vt) const
+    {
+        for (int openVt : qAsConst(openFds)) {
+            if (openVt == vt)
+                return true;
+        }
+        return false;
+    }
+
+protected:
+    int openVt(int vt) const override
+    {
+        const int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+            openFds.insert(fd, vt);
+        return fd;
+    }
+
+    void closeVt(int fd) const override
+    {
+        openFds.remove(fd);
+        ::close(fd);
+    }
+
+    int nextFreeVt() const override
+    {
+        for (int vt = 1; vt <= 63; ++vt) {
+            if (!isOpen(vt))
+                return vt;
+        }
+        return -1;
+    }
+
+    int activeVt() const override
+    {
+        return active;
+    }
+
+    QSet<int> loginSessionVts() const override
+    {
+        return sessions;
+    }
+};
+
+class VirtualTerminalManagerTest : public QObject {
+    Q_OBJECT
+private slots:
+    void reserveLowestFree()
+    {
+        FakeVirtualTerminalManager manager;
+        manager.sessions = { 1 };
+
+        QCOMPARE(manager.acquire(QStringLiteral("a")), 2);
+        QCOMPARE(manager.acquire(QStringLiteral("b")), 3);
+        QCOMPARE(manager.owner(2), QStringLiteral("a"));
+        QCOMPARE(manager.owner(3), QStringLiteral("b"));
+
+        // reservations are held open, the VT we skipped isn't
+        QVERIFY(manager.isOpen(2));
+        QVERIFY(manager.isOpen(3));
+        QVERIFY(!manager.isOpen(1));
+        QCOMPARE(manager.openFds.size(), 2);
+    }
+
+    void reuseReleased()
+    {
+        FakeVirtualTerminalManager manager;
+        manager.sessions = { 1 };
+
+        QCOMPARE(manager.acquire(QStringLiteral("a")), 2);
+        QCOMPARE(manager.acquire(QStringLiteral("b")), 3);
+        QCOMPARE(manager.acquire(QStringLiteral("c")), 4);
+
+        manager.release(3);
+        manager.release(2);
+        QVERIFY(!manager.isOpen(2));
+        QVERIFY(!manager.isOpen(3));
+        QCOMPARE(manager.GetFreeVts(), QList<int>({ 2, 3 }));
+
+        // released VTs come first, lowest first, then new ones
+        QCOMPARE(manager.acquire(QStringLiteral("d")), 2);
+        QCOMPARE(manager.acquire(QStringLiteral("e")), 3);
+        QCOMPARE(manager.acquire(QStringLiteral("f")), 5);
+        QVERIFY(manager.GetFreeVts().isEmpty());
+    }
+
+    void releaseNotReusable()
+    {
+        FakeVirtualTerminalManager manager;
+
+        QCOMPARE(manager.acquire(QStringLiteral("a")), 1);
+        manager.release(1, false);
+        QVERIFY(manager.GetFreeVts().isEmpty());
+        QVERIFY(manager.owner(1).isEmpty());
+
+        // releasing twice or something we never handed out does nothing
+        manager.release(1);
+        manager.release(7);
+        QVERIFY(manager.GetFreeVts().isEmpty());
+    }
+
+    void skipTakenOver()
+    {
+        FakeVirtualTerminalManager manager;
+        manager.sessions = { 1 };
+
+        QCOMPARE(manager.acquire(QStringLiteral("a")), 2);
+        QCOMPARE(manager.acquire(QStringLiteral("b")), 3);
+        manager.release(2);
+
+        // somebody logged in on the released VT in the meantime
+        manager.sessions.insert(2);
+        QCOMPARE(manager.acquire(QStringLiteral("c")), 4);
+        QVERIFY(manager.GetFreeVts().isEmpty());
+
+        // the VTs skipped while asking for a new one were closed again
+        QCOMPARE(manager.openFds.size(), 2);
+        QVERIFY(manager.isOpen(3));
+        QVERIFY(manager.isOpen(4));
+    }
+
+    void preferInitialVt()
+    {
+        FakeVirtualTerminalManager manager;
+        manager.active = SDDM_INITIAL_VT;
+
+        QCOMPARE(manager.acquire(QStringLiteral("a"), VirtualTerminalManager::PreferInitialVt), SDDM_INITIAL_VT);
+
+        // taken, and so is the active one: fall back to a new VT
+        const int vt = manager.acquire(QStringLiteral("b"), VirtualTerminalManager::PreferInitialVt);
+        QVERIFY(vt > 0);
+        QVERIFY(vt != SDDM_INITIAL_VT);
+
+        // once released it is handed out again
+        manager.release(SDDM_INITIAL_VT);
+        QCOMPARE(manager.acquire(QStringLiteral("c"), VirtualTerminalManager::PreferInitialVt), SDDM_INITIAL_VT);
+    }
+};
+
+QTEST_MAIN(VirtualTerminalManagerTest)
+
+#include "VirtualTerminalManagerTest.moc"
@@ -0,0 +1,112 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "XAuth.h"
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <X11/Xauth.h>
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+using namespace SDDM;
+
+class XAuthTest : public QObject {
+    Q_OBJECT
+private:
+    // all entries of the file, as libXau reads them
+    static QList<QByteArrayList> readEntries(const QString &fileName)
+    {
+        QList<QByteArrayList> entries;
+        FILE *fp = fopen(qPrintable(fileName), "rb");
+        if (!fp)
+            return entries;
+        while (Xauth *auth = XauReadAuth(fp)) {
+            entries << QByteArrayList {
+                QByteArray::number(auth->family),
+                QByteArray(auth->address, auth->address_length),
+                QByteArray(auth->number, auth->number_length),
+                QByteArray(auth->name, auth->name_length),
+                QByteArray(auth->data, auth->data_length),
+            };
+            XauDisposeAuth(auth);
+        }
+        fclose(fp);
+        return entries;
+    }
+
+private slots:
+    void writeCookieToFile()
+    {
+        QTemporaryDir dir;
+        const QString fileName = dir.filePath(QStringLiteral("xauth"));
+        const QByteArray cookie("0123456789abcdef");
+
+        QVERIFY(XAuth::writeCookieToFile(QStringLiteral(":12"), fileName, cookie));
+
+        const auto entries = readEntries(fileName);
+        QCOMPARE(entries.size(), 2);
+        QCOMPARE(entries[0][0], QByteArray::number(FamilyLocal));
+        QVERIFY(!entries[0][1].isEmpty());
+        QCOMPARE(entries[1][0], QByteArray::number(FamilyWild));
+        QCOMPARE(entries[1][1], QByteArray());
+        for (const auto &entry : entries) {
+            QCOMPARE(entry[2], QByteArray("12"));
+            QCOMPARE(entry[3], QByteArray("MIT-MAGIC-COOKIE-1"));
+            QCOMPARE(entry[4], cookie);
+        }
+
+        struct stat st;
+        QCOMPARE(stat(qPrintable(fileName), &st), 0);
+        QCOMPARE(st.st_mode & 0777, mode_t(0600));
+
+        QVERIFY(!XAuth::writeCookieToFile(QStringLiteral("12"), fileName, cookie));
+        QVERIFY(!XAuth::writeCookieToFile(QStringLiteral(":12"), fileName, cookie.left(8)));
+    }
+
+    void addCookie()
+    {
+        QTemporaryDir dir;
+        XAuth xauth;
+        xauth.setAuthDirectory(dir.path());
+        xauth.setup();
+        QCOMPARE(xauth.cookie().size(), 16);
+
+        // rewritten in place, longer and then shorter
+        for (const auto &display : { QStringLiteral(":0"), QStringLiteral(":10"), QStringLiteral(":1") }) {
+            QVERIFY(xauth.addCookie(display));
+            const auto entries = readEntries(xauth.authPath());
+            QCOMPARE(entries.size(), 2);
+            QCOMPARE(entries[1][2], QStringView{display}.mid(1).toUtf8());
+            QCOMPARE(entries[1][4], xauth.cookie());
+        }
+
+        XAuth other;
+        other.setAuthDirectory(dir.path());
+        other.setup();
+        QVERIFY(other.cookie() != xauth.cookie());
+    }
+};
+
+QTEST_MAIN(XAuthTest);
+
+#include "XAuthTest.moc"
@@ -0,0 +1,158 @@
+/***************************************************************************
+* Copyright (c) 2026 SDDM contributors
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the
+* Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+***************************************************************************/
+
+
+#include "XkbRules.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace SDDM;
+
+static const char s_rules[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<xkbConfigRegistry version=\"1.1\">\n"
+    "  <modelList>\n"
+    "    <model><configItem><name>pc105</name><description>Generic 105-key PC</description></configItem></model>\n"
+    "  </modelList>\n"
+    "  <layoutList>\n"
+    "    <layout>\n"
+    "      <configItem><name>us</name><shortDescription>en</shortDescription><description>English (US)</description></configItem>\n"
+    "      <variantList>\n"
+    "        <variant><configItem><name>intl</name><description>English (US, intl., with dead keys)</description></configItem></variant>\n"
+    "      </variantList>\n"
+    "    </layout>\n"
+    "    <layout>\n"
+    "      <configItem><name>de</name><description>German</description></configItem>\n"
+    "      <variantList>\n"
+    "        <variant><configItem><name>nodeadkeys</name><description>German (no dead keys)</description></configItem></variant>\n"
+    "      </variantList>\n"
+    "    </layout>\n"
+    "  </layoutList>\n"
+    "  <optionList>\n"
+    "    <group><configItem><name>grp</name><description>Switching to another layout</description></configItem></group>\n"
+    "  </optionList>\n"
+    "</xkbConfigRegistry>\n";
+
+class XkbRulesTest : public QObject {
+    Q_OBJECT
+private:
+    static bool writeRules(const QString &fileName, QByteArray contents, const QDateTime &modified)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(contents) != contents.size())
+            return false;
+        file.close();
+        if (!file.open(QIODevice::ReadWrite))
+            return false;
+        return file.setFileTime(modified, QFileDevice::FileModificationTime);
+    }
+
+private slots:
+    void descriptions()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(writeRules(dir.filePath(QStringLiteral("evdev.xml")), s_rules, QDateTime::currentDateTime()));
+
+        XkbRules rules(dir.filePath(QStringLiteral("evdev.xml")), dir.filePath(QStringLiteral("cache/rules")));
+        QVERIFY(rules.load());
+        QCOMPARE(rules.count(), 4);
+        QCOMPARE(rules.description(QStringLiteral("us")), QStringLiteral("English (US)"));
+        QCOMPARE(rules.description(QStringLiteral("us(intl)")), QStringLiteral("English (US, intl., with dead keys)"));
+        QCOMPARE(rules.description(QStringLiteral("de(nodeadkeys)")), QStringLiteral("German (no dead keys)"));
+        QCOMPARE(rules.description(QStringLiteral("de")), QStringLiteral("German"));
+
+        // models and options aren't layouts
+        QVERIFY(rules.description(QStringLiteral("pc105")).isEmpty());
+        QVERIFY(rules.description(QStringLiteral("grp")).isEmpty());
+        QVERIFY(rules.description(QStringLiteral("fr")).isEmpty());
+
+        QVERIFY(QFile::exists(dir.filePath(QStringLiteral("cache/rules"))));
+    }
+
+    void cacheInvalidation()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString rulesFile = dir.filePath(QStringLiteral("evdev.xml"));
+        const QString cacheFile = dir.filePath(QStringLiteral("rules.cache"));
+        const QDateTime modified = QDateTime::currentDateTime().addSecs(-60);
+        QVERIFY(writeRules(rulesFile, s_rules, modified));
+
+        {
+            XkbRules rules(rulesFile, cacheFile);
+            QVERIFY(rules.load());
+        }
+
+        // same size and time, so the cache is used instead of the new contents
+        QByteArray changed(s_rules);
+        changed.replace("German</description>", "GERMAN</description>");
+        QCOMPARE(changed.size(), QByteArray(s_rules).size());
+        QVERIFY(writeRules(rulesFile, changed, modified));
+        {
+            XkbRules rules(rulesFile, cacheFile);
+            QVERIFY(rules.load());
+            QCOMPARE(rules.description(QStringLiteral("de")), QStringLiteral("German"));
+        }
+
+        // a new modification time invalidates it
+        QVERIFY(writeRules(rulesFile, changed, modified.addSecs(1)));
+        {
+            XkbRules rules(rulesFile, cacheFile);
+            QVERIFY(rules.load());
+            QCOMPARE(rules.description(QStringLiteral("de")), QStringLiteral("GERMAN"));
+        }
+    }
+
+    void corruptCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString rulesFile = dir.filePath(QStringLiteral("evdev.xml"));
+        const QString cacheFile = dir.filePath(QStringLiteral("rules.cache"));
+        QVERIFY(writeRules(rulesFile, s_rules, QDateTime::currentDateTime()));
+
+        QFile cache(cacheFile);
+        QVERIFY(cache.open(QIODevice::WriteOnly));
+        cache.write("garbage");
+        cache.close();
+
+        XkbRules rules(rulesFile, cacheFile);
+        QVERIFY(rules.load());
+        QCOMPARE(rules.description(QStringLiteral("us")), QStringLiteral("English (US)"));
+    }
+
+    void missingRules()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        XkbRules rules(dir.filePath(QStringLiteral("evdev.xml")), dir.filePath(QStringLiteral("rules.cache")));
+        QVERIFY(!rules.load());
+        QCOMPARE(rules.count(), 0);
+        QVERIFY(rules.description(QStringLiteral("us")).isEmpty());
+    }
+};
+
+QTEST_MAIN(XkbRulesTest);
+
+#include "XkbRulesTest.moc"